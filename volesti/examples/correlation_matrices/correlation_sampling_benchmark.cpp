@@ -0,0 +1,60 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2021 Vissarion Fisikopoulos
+// Copyright (c) 2018-2021 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+// Time uniform_correlation_sampling_MT for matrices of size n = 50, ..., 500
+// with a membership based walk (BallWalk) and two boundary oracle based walks.
+// BilliardWalk makes O(d) reflections per point, so it runs only for n <= 100.
+
+#include <iostream>
+#include <chrono>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "cartesian_geom/cartesian_kernel.h"
+#include "convex_bodies/spectrahedra/spectrahedron.h"
+#include "random_walks/random_walks.hpp"
+#include "sampling/sample_correlation_matrices.hpp"
+
+typedef double                                              NT;
+typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>   MT;
+
+typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3>   RNGType;
+typedef CorreMatrix<NT>                                     PointMT;
+
+template<typename WalkType>
+void benchmark_sampling_MT(const unsigned int n, const unsigned int num_points, std::string walkname){
+
+    std::list<MT> randCorMatrices;
+    unsigned int walkL = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    uniform_correlation_sampling_MT<WalkType, PointMT, RNGType>(n, randCorMatrices, walkL, num_points, 0);
+    auto end = std::chrono::steady_clock::now();
+
+    double time = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << walkname << ", n = " << n << " : " << time / num_points << " (ms per point)" << std::endl;
+}
+
+int main(int argc, char const *argv[]){
+
+    std::vector<unsigned int> dimensions = {50, 100, 200, 300, 500};
+
+    for(unsigned int n : dimensions){
+        unsigned int num_points = (n <= 100) ? 200 : 20;
+
+        benchmark_sampling_MT<BallWalk>(n, num_points, "BallWalk");
+
+        benchmark_sampling_MT<RDHRWalk>(n, num_points, "RDHRWalk");
+
+        if (n <= 100) {
+            benchmark_sampling_MT<BilliardWalk>(n, 20, "BilliardWalk");
+        }
+    }
+
+    return 0;
+}
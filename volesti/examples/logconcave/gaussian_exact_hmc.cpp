@@ -15,6 +15,7 @@
 #include "volume/volume_cooling_gaussians.hpp"
 #include "sampling/sampling.hpp"
 #include "generators/known_polytope_generators.h"
+#include "generators/h_polytopes_generator.h"
 #include "diagnostics/multivariate_psrf.hpp"
 
 
@@ -54,7 +55,62 @@ void run_main()
     std::cerr << "PSRF: " <<  multivariate_psrf<NT, VT, MT>(samples) << std::endl;
 }
 
+// Time exact HMC on random H-polytopes with many facets with the scalar and the vectorized
+// trigonometric boundary oracle. Both give the same samples. With a small variance few facets
+// can be hit and the cost is dominated by A r and A v; with a large one most facets pass the
+// C_i > b_i test and the atan/acos evaluations of the scalar loop dominate.
+template <typename NT>
+void benchmark_reflections(unsigned int dim, unsigned int m, NT variance)
+{
+    typedef Cartesian<NT>    Kernel;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope <Point> Hpolytope;
+
+    Hpolytope P = random_hpoly<Hpolytope, boost::mt19937>(dim, m, 127);
+    P.set_InnerBall(std::pair<Point,NT>(Point(dim), NT(10) / NT(2)));
+
+    unsigned int walkL = 1, numpoints = 100, nburns = 0;
+    NT a = NT(1) / (NT(2) * variance);
+    double elapsed[2];
+    std::vector<Point> samples[2];
+
+    for (int vectorized = 0; vectorized < 2; vectorized++) {
+        P.set_vectorized_trigonometric_oracle(vectorized == 1);
+        std::list<Point> randPoints;
+        RNGType rng(dim);
+        Point StartingPoint(dim);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        gaussian_sampling<GaussianHamiltonianMonteCarloExactWalk>(randPoints, P, rng, walkL, numpoints, a,
+                                                                  StartingPoint, nburns);
+        auto stop = std::chrono::high_resolution_clock::now();
+        elapsed[vectorized] = std::chrono::duration<double, std::milli>(stop - start).count() / numpoints;
+        samples[vectorized].assign(randPoints.begin(), randPoints.end());
+    }
+
+    bool same = true;
+    for (unsigned int i = 0; i < numpoints; i++) {
+        same = same && (samples[0][i].getCoefficients() == samples[1][i].getCoefficients());
+    }
+
+    std::cout << "d = " << dim << ", m = " << m << ", variance = " << variance
+              << ": scalar " << elapsed[0] << " ms, vectorized " << elapsed[1]
+              << " ms per sample (speedup " << elapsed[0] / elapsed[1]
+              << (same ? ", same samples)" : ", DIFFERENT samples)") << std::endl;
+}
+
 int main() {
   run_main<double>();
+
+  for (unsigned int dim : {10, 50})
+  {
+      for (unsigned int m : {1000, 10000, 50000})
+      {
+          benchmark_reflections<double>(dim, m, 1.0);
+          benchmark_reflections<double>(dim, m, 10.0);
+          benchmark_reflections<double>(dim, m, 1000.0);
+      }
+  }
   return 0;
 }
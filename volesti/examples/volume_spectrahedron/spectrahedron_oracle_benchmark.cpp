@@ -0,0 +1,107 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2018-2020 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+// Compare the cold-started and the warm-started boundary oracle of a spectrahedron
+// by running billiard trajectories and reporting reflections per second.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include "misc.h"
+#include "random.hpp"
+#include "random/uniform_int.hpp"
+#include "random/normal_distribution.hpp"
+#include "random/uniform_real_distribution.hpp"
+
+#include "random_walks/random_walks.hpp"
+
+#include "matrix_operations/EigenvaluesProblems.h"
+#include "SDPAFormatManager.h"
+#include "convex_bodies/spectrahedra/spectrahedron.h"
+
+
+template <typename NT, typename Spectrahedron, typename RNGType>
+void billiard_reflections(Spectrahedron &P, bool warm_start, unsigned int num_trajectories, RNGType &rng)
+{
+    typedef typename Spectrahedron::PointType Point;
+
+    const unsigned int max_reflections = 10 * P.dimension();
+    NT L = compute_diameter<Spectrahedron>::template compute<NT>(P);
+
+    P.set_warm_start_oracle(warm_start);
+    Point p(P.dimension());
+    unsigned long reflections = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < num_trajectories; ++i) {
+        NT T = -std::log(rng.sample_urdist()) * L;
+        Point v = GetDirection<Point>::apply(P.dimension(), rng);
+        P.resetFlags();
+
+        for (unsigned int it = 0; it < max_reflections; ++it) {
+            NT lambda = P.line_positive_intersect(p, v).first;
+            if (T <= lambda) {
+                p += (T * v);
+                break;
+            }
+            lambda *= NT(0.995);
+            p += (lambda * v);
+            T -= lambda;
+            P.compute_reflection(v, p);
+            reflections++;
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double time = std::chrono::duration<double>(end - start).count();
+
+    std::cout << (warm_start ? "  warm-started oracle: " : "  cold-started oracle: ")
+              << reflections << " reflections in " << time << " secs, "
+              << NT(reflections) / time << " reflections/sec";
+    if (warm_start) {
+        std::cout << ", fallbacks to full solver: " << P.num_warm_start_fallbacks
+                  << "/" << P.num_warm_start_calls;
+    }
+    std::cout << std::endl;
+}
+
+
+template <typename NT>
+void benchmark_oracles(std::string const& name, unsigned int num_trajectories)
+{
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef Spectrahedron<Point> spectrahedron;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+
+    SdpaFormatManager<NT> sdpaFormatManager;
+
+    std::ifstream in;
+    spectrahedron spectra;
+    Point objFunction;
+    in.open("./../../test/spectra_data/" + name + ".txt", std::ifstream::in);
+    sdpaFormatManager.loadSDPAFormatFile(in, spectra, objFunction);
+    spectra.set_interior_point(Point(spectra.dimension()));
+
+    std::cout << "--- " << name << std::endl;
+
+    RNGType rng_cold(spectra.dimension());
+    billiard_reflections<NT>(spectra, false, num_trajectories, rng_cold);
+
+    RNGType rng_warm(spectra.dimension());
+    billiard_reflections<NT>(spectra, true, num_trajectories, rng_warm);
+}
+
+
+int main() {
+
+    benchmark_oracles<double>("sdp_prob_20_20", 100);
+    benchmark_oracles<double>("sdp_prob_200_15", 50);
+    benchmark_oracles<double>("sdp_prob_400_20", 20);
+    benchmark_oracles<double>("sdp_prob_600_25", 10);
+
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include "Eigen/Eigen"
 #include "SparseMatrix.h"
 #include "chol.h"
+#include "cholupdate.h"
 #include "leverage.h"
 #include "leverageJL.h"
 #include "multiply.h"
@@ -47,6 +48,10 @@ template <int k, typename Ti> struct PackedChol {
       numExact; // number of times we perform high precision decompose (length
                 // k+1, the last one records how many times we do decompose)
   bool decomposed = false;
+  size_t updateThreshold = 0; // maximum number of changed weights for which L is
+                              // updated by rank-1 up/downdates (0 disables it)
+  size_t numUpdate = 0;       // number of times L was updated instead of recomputed
+  size_t numUpdateFallback = 0; // number of failed updates (L was recomputed)
 
   // preprocess info for different CSparse operations (PackedDouble)
   MultiplyOutput<Tx2, Ti> H;         // cache for H = A W A'
@@ -134,6 +139,59 @@ template <int k, typename Ti> struct PackedChol {
     return acc;
   }
 
+  // Same as decompose, but if at most updateThreshold entries of w changed
+  // since the last call, L is updated in place by rank-1 up/downdates instead
+  // of computing chol(A W A') from scratch. It falls back to decompose if an
+  // update fails or if the accuracy of the updated L is below accuracyThreshold.
+  template <typename Tv2_> Tx2 updateOrDecompose(const Tv2_ *w_in) {
+    if (!decomposed || hasExact() || updateThreshold == 0)
+      return decompose(w_in);
+
+    Ti n = A.n;
+    std::vector<Ti> changed;
+    for (Ti j = 0; j < n; j++) {
+      for (size_t i = 0; i < k; i++) {
+        if (get(w[j], i) != get(w_in[j], i)) {
+          changed.push_back(j);
+          break;
+        }
+      }
+      if (changed.size() > updateThreshold)
+        return decompose(w_in);
+    }
+
+    Tx2 acc = Tx2(0.0);
+    if (changed.empty())
+      return acc;
+
+    std::vector<double> work(A.m, 0.0);
+    bool ok = true;
+    for (Ti j : changed) {
+      for (size_t i = 0; i < k && ok; i++) {
+        double delta = get(w_in[j], i) - get(w[j], i);
+        ok = chol_updown(L, A, j, i, delta, work.data());
+      }
+      if (!ok)
+        break;
+      w[j] = w_in[j];
+    }
+
+    if (ok && accuracyThreshold > 0.0) {
+      acc = estimateAccuracy();
+      for (size_t i = 0; i < k; i++) {
+        if (get(acc, i) >= accuracyThreshold)
+          ok = false;
+      }
+    }
+
+    if (!ok) {
+      ++numUpdateFallback;
+      return decompose(w_in);
+    }
+    ++numUpdate;
+    return acc;
+  }
+
   Tx2 logdet() {
     pcs_assert(decomposed, "logdet: Need to call decompose first.");
 
@@ -0,0 +1,90 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2018 Vissarion Fisikopoulos
+// Copyright (c) 2018 Apostolos Chalkis
+// Copyright (c) 2022 Ioannis Iakovidis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "SparseMatrix.h"
+#include "chol.h"
+
+// Problem:
+// Given L = chol(A diag(w) A'), compute chol(A diag(w + delta e_j) A') = chol(L L' + delta a_j a_j')
+// where a_j is the j-th column of A.
+
+// Algorithm:
+// Rank-1 update (delta > 0) or downdate (delta < 0) of Davis and Hager, as in cs_updown of CSparse.
+// The pattern of A diag(w) A' does not depend on w, so the pattern of L already contains the
+// path of the elimination tree starting at min(find(a_j)) and L can be modified in place.
+// Each packed lane has its own delta, hence the update is done lane by lane.
+
+namespace PackedCSparse {
+	// work is a workspace of size L.n which must be 0 on entry and is 0 on exit.
+	// Returns false if the downdated matrix is not positive definite. In that case
+	// the lane of L is partially modified and must be recomputed from scratch.
+	template <typename Tx, typename Ti>
+	bool chol_updown(CholOutput<Tx, Ti>& o, const SparseMatrix<double, Ti>& A, Ti j, size_t lane, double delta, double* work)
+	{
+		pcs_assert(o.initialized(), "chol_updown: Need to call chol first.");
+
+		Ti* Ap = A.p.get(), * Ai = A.i.get(); double* Ax = A.x.get();
+		Ti* Lp = o.p.get(), * Li = o.i.get(); Tx* Lx = o.x.get();
+
+		if (Ap[j] >= Ap[j + 1] || delta == 0.0)
+			return true;
+
+		double sigma = (delta > 0) ? 1.0 : -1.0;
+		double scale = std::sqrt(std::abs(delta));
+
+		Ti f = Ai[Ap[j]];
+		for (Ti s = Ap[j]; s < Ap[j + 1]; s++)
+		{
+			f = std::min(f, Ai[s]);
+			work[Ai[s]] = scale * Ax[s];
+		}
+
+		// parent of k in the elimination tree is the first off-diagonal non-zero of L_{:,k}
+		auto parent = [&](Ti k) -> Ti { return (Lp[k] + 1 < Lp[k + 1]) ? Li[Lp[k] + 1] : Ti(-1); };
+
+		bool ok = true;
+		double beta = 1.0;
+		Ti k = f;
+		for (; k != -1; k = parent(k))
+		{
+			Ti s = Lp[k];
+			double Lkk = get(Lx[s], lane);
+			double alpha = work[k] / Lkk;
+			double beta2 = beta * beta + sigma * alpha * alpha;
+			if (beta2 <= 0)
+			{
+				ok = false;
+				break;
+			}
+			beta2 = std::sqrt(beta2);
+			double d = (sigma > 0) ? (beta / beta2) : (beta2 / beta);
+			double gamma = sigma * alpha / (beta2 * beta);
+			set(Lx[s], lane, d * Lkk + ((sigma > 0) ? (gamma * work[k]) : 0.0));
+			beta = beta2;
+			work[k] = 0.0;
+
+			for (s++; s < Lp[k + 1]; s++)
+			{
+				Ti i = Li[s];
+				double w1 = work[i];
+				double w2 = w1 - alpha * get(Lx[s], lane);
+				work[i] = w2;
+				set(Lx[s], lane, d * get(Lx[s], lane) + gamma * ((sigma > 0) ? w1 : w2));
+			}
+		}
+
+		// the remaining non-zeros of work lie on the rest of the path
+		for (; k != -1; k = parent(k))
+			work[k] = 0.0;
+
+		return ok;
+	}
+}
@@ -22,6 +22,9 @@
 #define KHACH_H
 
 #include <set>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <Eigen/Eigen>
 
@@ -95,12 +98,36 @@
                 const VTT<double> &p,
                 MTT<double> &Lambdap)
   {
+    Lambdap.noalias() = Ap * p.asDiagonal() * Ap.transpose();
+  }
+
+  /// Number of lifted points per block in KaVariances
+  const Eigen::Index KaBlockSize = 256;
 
-    MTT<double> dp(p.size(), p.size());
-    genDiag(p, dp);
+  /// Iterations between two full recomputations of Lambda^{-1} and of the
+  /// variances; in between both are kept by rank-one updates
+  const size_t KaRefreshPeriod = 32;
 
-    dp = dp * Ap.transpose();
-    Lambdap.noalias() = Ap * dp;
+  /// Variance function g_i = ap_i^T Lambda^{-1} ap_i for every column of Ap.
+  /// Only the diagonal of Ap^T Lambda^{-1} Ap is formed, one block of
+  /// columns at a time, and the blocks are evaluated in parallel.
+  inline void KaVariances(const MTT<double> &Ap,
+                          const MTT<double> &ILp,
+                          VTT<double> &g)
+  {
+    const Eigen::Index N = Ap.cols();
+    const Eigen::Index num_blocks = (N + KaBlockSize - 1) / KaBlockSize;
+    g.resize(N);
+
+    #pragma omp parallel for schedule(static)
+    for (Eigen::Index k = 0; k < num_blocks; ++k)
+    {
+      const Eigen::Index first = k * KaBlockSize;
+      const Eigen::Index len = std::min(KaBlockSize, N - first);
+      MTT<double> ILpA = ILp * Ap.middleCols(first, len);
+      g.segment(first, len) = ILpA.cwiseProduct(Ap.middleCols(first, len))
+                                  .colwise().sum().transpose();
+    }
   }
 
   inline double KhachiyanIter(const MTT<double> &Ap, VTT<double> &p)
@@ -109,20 +136,19 @@
     const size_t d = Ap.rows()-1;
 
     MTT<double> Lp;
-    MTT<double> M;
     KaLambda(Ap, p, Lp);
     MTT<double> ILp(Lp.rows(), Lp.cols());
     InvertLP(Lp, ILp);
-    M.noalias() = ILp * Ap;
-    M = Ap.transpose() * M;
+    VTT<double> g;
+    KaVariances(Ap, ILp, g);
 
     double maxval=0;
     size_t maxi=0;
-    for(size_t i=0; i<M.rows(); ++i)
+    for(size_t i=0; i<g.size(); ++i)
     {
-      if (M(i,i) > maxval)
+      if (g(i) > maxval)
       {
-        maxval=M(i,i);
+        maxval=g(i);
         maxi=i;
       }
     }
@@ -136,18 +162,25 @@
 
   }
 
+  /// Harman-Pronzato test: a point whose variance is below the returned bound
+  /// cannot support the minimum volume ellipsoid, so it can be dropped for good.
+  /// n is the dimension of the lifted space and maxval the largest variance.
+  inline double KaEliminationBound(double maxval, double n)
+  {
+    const double e = maxval - n;
+    if (e <= 0.0) return 0.0;
+    return n * (1.0 + e/2.0 - std::sqrt(e * (4.0 + e - 4.0/n))/2.0);
+  }
+
   inline void KaInvertDual(const MTT<double> &A, 
                       const VTT<double> &p, 
                       MTT<double> &Q, 
                       VTT<double> &c)
   {
     const size_t d = A.rows();
-    MTT<double> dp(p.size(), p.size());
-    genDiag(p, dp);
 
     MTT<double> PN;
-    PN.noalias() = dp * A.transpose();
-    PN = A * PN;
+    PN.noalias() = A * p.asDiagonal() * A.transpose();
 
     VTT<double> M2;
     M2.noalias() = A * p;
@@ -162,25 +195,91 @@
 
   }
 
+  /// Khachiyan's algorithm (Todd-Yildirim form). Every KaRefreshPeriod
+  /// iterations Lambda^{-1} and the variances are recomputed from scratch and
+  /// the points that fail the Harman-Pronzato test leave the active set;
+  /// the remaining iterations cost O(N d) by Sherman-Morrison updates.
   inline double KhachiyanAlgo(const MTT<double> &A,
                        double eps,
                        size_t maxiter,
                        MTT<double> &Q,
                        VTT<double> &c)
   {
-    VTT<double> p(A.cols());
-    p.setConstant(1.0/A.cols());
+    const double n = double(A.rows() + 1);
+    const Eigen::Index N = A.cols();
 
+    // Lifted active points, their weights and their indices in A
     MTT<double> Ap;
     Lift(A, Ap);
+    VTT<double> p(N);
+    p.setConstant(1.0/N);
+    std::vector<Eigen::Index> active(N);
+    for (Eigen::Index j = 0; j < N; ++j) active[j] = j;
+
+    MTT<double> Lp, ILp;
+    VTT<double> g, u, v;
 
     double ceps=eps*2;
     for (size_t i=0;  i<maxiter && ceps>eps; ++i)
     {
-      ceps=KhachiyanIter(Ap, p);
+      if (i % KaRefreshPeriod == 0)
+      {
+        KaLambda(Ap, p, Lp);
+        InvertLP(Lp, ILp);
+        KaVariances(Ap, ILp, g);
+
+        const double bound = KaEliminationBound(g.maxCoeff(), n);
+        Eigen::Index kept = 0;
+        double kept_weight = 0.0;
+        for (Eigen::Index j = 0; j < Ap.cols(); ++j)
+        {
+          if (g(j) < bound) continue;
+          if (kept != j)
+          {
+            Ap.col(kept) = Ap.col(j);
+            p(kept) = p(j);
+            g(kept) = g(j);
+            active[kept] = active[j];
+          }
+          kept_weight += p(kept);
+          ++kept;
+        }
+        if (kept < Ap.cols())
+        {
+          Ap.conservativeResize(Eigen::NoChange, kept);
+          p.conservativeResize(kept);
+          active.resize(kept);
+          p /= kept_weight;
+          KaLambda(Ap, p, Lp);
+          InvertLP(Lp, ILp);
+          KaVariances(Ap, ILp, g);
+        }
+      }
+
+      Eigen::Index maxi;
+      const double maxval = g.maxCoeff(&maxi);
+      const double step_size = (maxval - n)/(n*(maxval - 1));
+
+      // ||p_new - p|| = step_size * ||e_maxi - p||
+      ceps = std::abs(step_size)
+           * std::sqrt(std::max(0.0, p.squaredNorm() - 2.0*p(maxi) + 1.0));
+
+      // Lambda_new = (1-s) Lambda + s a a^T
+      const double denom = (1.0 - step_size) + step_size * maxval;
+      u.noalias() = ILp * Ap.col(maxi);
+      v.noalias() = Ap.transpose() * u;
+      ILp.noalias() -= (step_size/denom) * u * u.transpose();
+      ILp /= (1.0 - step_size);
+      g = (g - (step_size/denom) * v.cwiseAbs2()) / (1.0 - step_size);
+
+      p *= (1.0 - step_size);
+      p(maxi) += step_size;
     }
 
-    KaInvertDual(A, p, Q, c);
+    VTT<double> weights = VTT<double>::Zero(N);
+    for (Eigen::Index j = 0; j < Ap.cols(); ++j) weights(active[j]) = p(j);
+
+    KaInvertDual(A, weights, Q, c);
 
     return ceps;
 
@@ -12,6 +12,7 @@
 
 
 #include "convex_bodies/spectrahedra/spectrahedron.h"
+#include "convex_bodies/spectrahedra/block_spectrahedron.h"
 
 #include <string>
 #include <sstream>
@@ -98,11 +99,12 @@ private:
 
 public:
 
-    /// Reads an SDPA format file
+    /// Reads an SDPA format file keeping the block diagonal structure of the matrices.
+    /// A diagonal block of size k (negative block size in SDPA format) is stored as k blocks of size 1.
     /// \param[in] is An open stram pointing to the file
-    /// \param[out] matrices the matrices A0, A1, A2, ..., An
+    /// \param[out] blocks blocks[i][j] is the j-th diagonal block of the matrix A_i, i = 0, ..., n
     /// \param[out] objectiveFunction The objective function of the sdp
-    void loadSDPAFormatFile(std::ifstream &is, std::vector<MT> &matrices, VT &objectiveFunction) {
+    void loadSDPAFormatFile(std::ifstream &is, std::vector<std::vector<MT>> &blocks, VT &objectiveFunction) {
         std::string line;
         std::string::size_type sz;
 
@@ -145,21 +147,20 @@ public:
             constantVector.insert(std::end(constantVector), std::begin(t), std::end(t));
         }
 
-        matrices = std::vector<MT>(variablesNum + 1);
-        int matrixDim = 0;
-        for (auto x : blockStructure)
-            matrixDim += std::abs((int) x);
+        blocks = std::vector<std::vector<MT>>(variablesNum + 1);
 
         //read constraint matrices
-        for (int atMatrix = 0; atMatrix < matrices.size(); atMatrix++) {
-            MT matrix;
-            matrix.setZero(matrixDim, matrixDim);
+        for (int atMatrix = 0; atMatrix < blocks.size(); atMatrix++) {
 
-            int offset = 0;
+            //the LMI in SDPA format is >0, I want it <0
+            //F0 has - before it in SDPA format, the rest have +
+            NT sign = (atMatrix == 0) ? NT(1) : NT(-1);
 
             for (auto blockSize : blockStructure) {
 
                 if (blockSize > 0) { //read a block blockSize x blockSize
+                    MT block;
+                    block.setZero(blockSize, blockSize);
                     int at = 0;
                     int i = 0, j = 0;
 
@@ -170,7 +171,7 @@ public:
                         listVector vec = readVector(line);
 
                         for (double value : vec) {
-                            matrix(offset + i, offset + j) = value;
+                            block(i, j) = sign * value;
                             at++;
                             if (at % (int) blockSize == 0) { // new row
                                 i++;
@@ -181,6 +182,8 @@ public:
                         }
                     } /* while (at<blockSize*blockSize) */
 
+                    blocks[atMatrix].push_back(block);
+
                 } else { //read diagonal block
                     blockSize = std::abs(blockSize);
                     int at = 0;
@@ -192,23 +195,15 @@ public:
                         listVector vec = readVector(line);
 
                         for (double value : vec) {
-                            matrix(offset + at, offset + at) = value;
+                            blocks[atMatrix].push_back(MT::Constant(1, 1, sign * value));
                             at++;
                         }
                     } /* while (at<blockSize) */
                 }
-
-                offset += std::abs(blockSize);
             } /* for (auto blockSize : blockStructure) */
-
-            //the LMI in SDPA format is >0, I want it <0
-            if (atMatrix == 0) //F0 has - before it in SDPA format, the rest have +
-                matrices[atMatrix] = matrix;
-            else
-                matrices[atMatrix] = -1 * matrix;
         }
 
-        // return lmi and objective function
+        // return objective function
         objectiveFunction.setZero(variablesNum);
         int at = 0;
 
@@ -216,6 +211,35 @@ public:
             objectiveFunction(at++) = value;
     }
 
+    /// Reads an SDPA format file
+    /// \param[in] is An open stram pointing to the file
+    /// \param[out] matrices the matrices A0, A1, A2, ..., An
+    /// \param[out] objectiveFunction The objective function of the sdp
+    void loadSDPAFormatFile(std::ifstream &is, std::vector<MT> &matrices, VT &objectiveFunction) {
+        std::vector<std::vector<MT>> blocks;
+        loadSDPAFormatFile(is, blocks, objectiveFunction);
+
+        int matrixDim = 0;
+        for (auto const& block : blocks[0])
+            matrixDim += block.rows();
+
+        matrices = std::vector<MT>(blocks.size());
+
+        // place the blocks on the diagonal
+        for (int atMatrix = 0; atMatrix < blocks.size(); atMatrix++) {
+            MT matrix;
+            matrix.setZero(matrixDim, matrixDim);
+
+            int offset = 0;
+            for (auto const& block : blocks[atMatrix]) {
+                matrix.block(offset, offset, block.rows(), block.cols()) = block;
+                offset += block.rows();
+            }
+
+            matrices[atMatrix] = matrix;
+        }
+    }
+
     /// Create a SDPA format file
     /// \param[in] os Open stream to file
     /// \param[in] matrices The matrices A0, ..., An
@@ -255,6 +279,22 @@ public:
     }
 
 
+    /// Read a block diagonal spectrahedron and a vector (objective function) from a SDPA format input file
+    /// \tparam Point
+    /// \param[in] is opened stream to input file
+    /// \param[out] spectrahedron
+    /// \param[out] objectiveFunction
+    template <typename Point>
+    void loadSDPAFormatFile(std::ifstream &is, BlockSpectrahedron<Point> &spectrahedron, Point &objectiveFunction) {
+        std::vector<std::vector<MT>> blocks;
+        VT coeffs;
+        loadSDPAFormatFile(is, blocks, coeffs);
+        BlockLMI<NT, MT, VT> lmi(blocks);
+        spectrahedron = BlockSpectrahedron<Point>(lmi);
+        objectiveFunction = Point(coeffs);
+    }
+
+
     /// Write a spectrahedron and a vector (objective function) to a SDPA format output file
     /// \tparam Point
     /// \param[in] is opened stream to output file
@@ -126,15 +126,14 @@ class CorrelationSpectrahedron : public Spectrahedron<Point>{
     /// \param[in, out] _precomputedValues Holds matrices B = I - A(v), A = A(p)
     void createMatricesForPositiveLinearIntersection(VT const &p, VT const &v){
         if (true) {
-            VT pvector = p, vvector = v;
-            NT coeff;
+            VT const& pvector = p;
+            VT const& vvector = v;
             int i, j, ind =0;
+            // the eigensolvers read only the lower triangular parts of A and B
             for(i = 0; i < n ; ++i){
                 for(j = 0; j < i; ++j){
-                    coeff = -pvector[ind];
-                    _precomputedValues.A(i,j) = _precomputedValues.A(j,i) = coeff;
-                    coeff = -vvector[ind];
-                    _precomputedValues.B(i,j) = _precomputedValues.B(j,i) = coeff;
+                    _precomputedValues.A(i,j) = -pvector[ind];
+                    _precomputedValues.B(i,j) = -vvector[ind];
                     ++ind;
                 }
             }
@@ -249,9 +248,16 @@ class CorrelationSpectrahedron : public Spectrahedron<Point>{
     }
 
     bool isExterior(VT const &pos) const {
-        MT mat = MT(n, n);
-        buildMatrix(pos, n, mat);
-        return isExterior(mat);
+        // build only the lower triangular part of the correlation matrix
+        MT mat = MT::Identity(n, n);
+        int i, j, ind = 0;
+        for(i = 0; i < n ; ++i){
+            for(j = 0; j < i; ++j){
+                mat(i,j) = pos[ind];
+                ++ind;
+            }
+        }
+        return !this->EigenvaluesProblem.isPositiveDefinite(mat);
     }
 
     bool isExterior(MT const &mat) const {
@@ -35,7 +35,8 @@ class CorrelationSpectrahedron_MT : public Spectrahedron<CorreMatrix>{
         int i,j;
         this->n = n;
         this->d = n*(n-1)/2;
-        this->_inner_ball.first = PointType(this->d);
+        // the center of the inner ball is the n x n identity matrix
+        this->_inner_ball.first = PointType(n);
         this->_inner_ball.second = 1/std::sqrt(this->d);
         this->eigenvector.setZero(n);
     }
@@ -55,20 +56,24 @@ class CorrelationSpectrahedron_MT : public Spectrahedron<CorreMatrix>{
     /// \param[out] reflectedDirection The reflected direction
     template <typename update_parameters>
     void compute_reflection(PointType &v, PointType const &r, update_parameters&) const {
-        MT grad = MT::Zero(this->n, this->n);
         int i, j;
-        NT sum_sq = NT(0), dot = NT(0);
+        NT grad, sum_sq = NT(0), dot = NT(0);
 
         for(i = 0; i < n ; ++i){
             for(j = 0; j < i; ++j){
-                grad(i,j) = eigenvector[i]*eigenvector[j];
-                sum_sq += grad(i,j)*grad(i,j);
-                dot += grad(i,j) * v.mat(i,j);
+                grad = eigenvector[i]*eigenvector[j];
+                sum_sq += grad*grad;
+                dot += grad * v.mat(i,j);
             }
         }
         dot = 2 * dot / sum_sq;
-        grad = dot*grad;
-        v -= PointType(grad);
+
+        // update the lower triangular part of v in place
+        for(i = 0; i < n ; ++i){
+            for(j = 0; j < i; ++j){
+                v.mat(i,j) -= dot * eigenvector[i]*eigenvector[j];
+            }
+        }
     }
 
     /// Computes the minimal positive t s.t. r+t*v intersects the boundary of the spectrahedron
@@ -162,14 +167,14 @@ class CorrelationSpectrahedron_MT : public Spectrahedron<CorreMatrix>{
     /// \param p is the current point
     /// \return true if position is outside the spectrahedron
     int is_in(PointType const &p, NT tol=NT(0)) const {
-        if(this->EigenvaluesProblem.isPositiveSemidefinite(p.mat)){
+        if(this->EigenvaluesProblem.isPositiveDefinite(p.mat)){
             return -1;
         }
         return 0;
     }
 
     bool isExterior(MT const &mat) const {
-        return !this->EigenvaluesProblem.isPositiveSemidefinite(mat);
+        return !this->EigenvaluesProblem.isPositiveDefinite(mat);
     }
 
     MT get_mat() const {
@@ -16,6 +16,8 @@
 #define HPOLYTOPE_H
 
 #include <limits>
+#include <numeric>
+#include <algorithm>
 #include <iostream>
 #include <Eigen/Eigen>
 #include "preprocess/max_inscribed_ball.hpp"
@@ -57,6 +59,7 @@ public:
     typedef Eigen::Matrix<NT, Eigen::Dynamic, 1>              VT;
     typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> DenseMT;
     typedef Eigen::SparseMatrix<NT, Eigen::RowMajor>         SparseRowMT;
+    typedef Eigen::SparseMatrix<NT, Eigen::ColMajor>         SparseColMT;
 
 private:
     unsigned int         _d; //dimension
@@ -66,25 +69,73 @@ private:
     bool                 normalized = false; // true if the polytope is normalized
     bool                 has_ball = false;
 
+    // Facet neighborhood index used by the billiard and exact hmc boundary oracles.
+    // It keeps the rows of the facets closest to an anchor point together with the
+    // distance from the anchor to the closest facet that is not kept. A trajectory
+    // that stays in the open ball of that radius around the anchor cannot hit any
+    // facet outside the neighborhood, so only the kept rows have to be scanned.
+    // The const oracles rebuild it, so it is not thread safe (see set_facet_index).
+    struct facet_neighborhood
+    {
+        unsigned int     size = 0; // number of facets kept, 0 disables the index
+        bool             valid = false;
+        VT               anchor;
+        NT               radius;
+        DenseMT          A_near;
+        VT               b_near;
+        std::vector<int> rows;
+        VT               row_norms;
+        unsigned int     hits_since_rebuild = 0;
+        unsigned int     backoff = 0; // full scans to skip before the next rebuild
+        unsigned int     skip = 0;
+        bool             stale_products = true; // Ar, Av of the caller not updated by the last call
+    };
+    mutable facet_neighborhood _facet_index;
+
+    // Column-major copy of the nonzeros of A used by the coordinate oracles. A move
+    // along coordinate i changes only the slacks of the rows in the support of column i,
+    // so a coordinate hit-and-run step costs O(nnz(A.col(i))) instead of O(m). The copy
+    // is rebuilt whenever A changes, so the const oracles never write to it; for a
+    // dense MT it is used only when A is sparse enough to pay off.
+    struct coordinate_index
+    {
+        bool        use = false;
+        SparseColMT cols;
+    };
+    coordinate_index _coord_index;
+
+    // use the vectorized block kernel in trigonometric_positive_intersect
+    bool _vectorized_trigonometric_oracle = true;
+
 public:
+    /// Number of boundary oracle calls answered by the facet neighborhood index
+    /// and number of full scans that rebuilt it
+    mutable unsigned int num_facet_index_hits = 0;
+    mutable unsigned int num_facet_index_rebuilds = 0;
+
     //TODO: the default implementation of the Big3 should be ok. Recheck.
     HPolytope() {}
 
     HPolytope(unsigned d_, MT const& A_, VT const& b_) :
         _d{d_}, A{A_}, b{b_}
     {
+        build_coordinate_index();
     }
 
     template<typename T = DenseMT>
     HPolytope(unsigned d_, DenseMT const& A_, VT const& b_, typename std::enable_if<!std::is_same<MT, T>::value, T>::type* = 0) :
         _d{d_}, A{A_.sparseView()}, b{b_}
     {
+        build_coordinate_index();
     }
 
     // Copy constructor
     HPolytope(HPolytope<Point, MT> const& p) :
-            _d{p._d}, A{p.A}, b{p.b}, _inner_ball{p._inner_ball}, normalized{p.normalized}, has_ball{p.has_ball}
+            _d{p._d}, A{p.A}, b{p.b}, _inner_ball{p._inner_ball}, normalized{p.normalized}, has_ball{p.has_ball},
+            _coord_index{p._coord_index},
+            _vectorized_trigonometric_oracle{p._vectorized_trigonometric_oracle}
     {
+        _facet_index.size = p._facet_index.size;
     }
 
     //define matrix A and vector b, s.t. Ax<=b,
@@ -101,6 +152,7 @@ public:
             }
         }
         has_ball = false;
+        build_coordinate_index();
         //_inner_ball = ComputeChebychevBall<NT, Point>(A, b);
     }
 
@@ -213,7 +265,7 @@ public:
         return A.row(facet_index);
     }
     
-    bool is_normalized ()
+    bool is_normalized () const
     {
         return normalized;
     }
@@ -225,6 +277,8 @@ public:
         A = A2;
         normalized = false;
         has_ball = false;
+        invalidate_facet_index();
+        build_coordinate_index();
     }
 
 
@@ -233,6 +287,34 @@ public:
     {
         b = b2;
         has_ball = false;
+        invalidate_facet_index();
+    }
+
+
+    // Enable the facet neighborhood index in the billiard and exact hmc boundary oracles.
+    // The oracles scan only the num_facets facets closest to the point of the last full
+    // scan and fall back to a full scan when they cannot prove that no other facet is hit
+    // first. In this mode the Ar and Av vectors passed to the oracles are only updated by
+    // the full scans. num_facets = 0 disables the index.
+    // The index and its counters are updated inside the const oracles, so it must stay
+    // disabled when the polytope is shared by walks running in parallel threads (the
+    // multi-chain volume_cooling_gaussians turns it off on its copy); give each thread
+    // its own copy of the polytope to use it in parallel.
+    void set_facet_index(unsigned int const& num_facets)
+    {
+        _facet_index = facet_neighborhood();
+        _facet_index.size = num_facets;
+        num_facet_index_hits = 0;
+        num_facet_index_rebuilds = 0;
+    }
+
+    // Use the vectorized kernel (the default) or the scalar loop in the boundary oracle of
+    // exact hmc. The kernel screens the facets with polynomial approximations of atan and
+    // acos and evaluates exactly only the few facets that may be hit first, so both give
+    // the same result; the scalar loop is kept for comparison.
+    void set_vectorized_trigonometric_oracle(bool const& vectorized)
+    {
+        _vectorized_trigonometric_oracle = vectorized;
     }
 
     Point get_mean_of_vertices() const
@@ -467,6 +549,9 @@ public:
                                                VT& Ar,
                                                VT& Av) const
     {
+        if (_facet_index.size > 0) {
+            return indexed_line_positive_intersect(r, v, Ar, Av);
+        }
         return line_intersect(r, v, Ar, Av, true);
     }
 
@@ -479,6 +564,9 @@ public:
                                                VT& Av,
                                                NT const& lambda_prev) const
     {
+        if (_facet_index.size > 0) {
+            return indexed_line_positive_intersect(r, v, Ar, Av, &lambda_prev);
+        }
         return line_intersect(r, v, Ar, Av, lambda_prev, true);
     }
 
@@ -680,14 +768,11 @@ public:
                                                     VT& Ar, VT& Av,
                                                     Params &params) const
     {
-        VT r_orig = params.L_inv.transpose().template triangularView<Eigen::Lower>().solve(r_rounded.getCoefficients());
-        VT v_orig = params.L_inv.transpose().template triangularView<Eigen::Lower>().solve(v_rounded.getCoefficients());
-
         NT lambda_min = std::numeric_limits<NT>::max();
         int facet = -1;
 
-        Ar = params.A_original * r_orig;
-        Av = params.A_original * v_orig;
+        params.apply_rounded_operator(r_rounded.getCoefficients(), Ar);
+        params.apply_rounded_operator(v_rounded.getCoefficients(), Av);
 
         for (int i = 0; i < params.A_original.rows(); ++i)
         {
@@ -713,11 +798,8 @@ public:
                                                     VT& Ar, VT& Av, NT lambda_prev,
                                                     Params &params) const
     {
-        VT r_orig = params.L_inv.transpose().template triangularView<Eigen::Lower>().solve(r_rounded.getCoefficients());
-        VT v_orig = params.L_inv.transpose().template triangularView<Eigen::Lower>().solve(v_rounded.getCoefficients());
-
         Ar.noalias() += lambda_prev * Av;
-        Av = params.A_original * v_orig;
+        params.apply_rounded_operator(v_rounded.getCoefficients(), Av);
 
         NT lambda_min = std::numeric_limits<NT>::max();
         int facet = -1;
@@ -752,12 +834,23 @@ public:
         NT lamda = 0;
         NT min_plus  = std::numeric_limits<NT>::max();
         NT max_minus = std::numeric_limits<NT>::lowest();
+
+        lamdas.noalias() = b - A * r.getCoefficients();
+
+        if (use_coordinate_index()) {
+            for (typename SparseColMT::InnerIterator it(_coord_index.cols, rand_coord); it; ++it) {
+                lamda = lamdas.coeff(it.index()) * (1 / it.value());
+                if (lamda < min_plus && lamda > 0) min_plus = lamda;
+                if (lamda > max_minus && lamda < 0) max_minus = lamda;
+            }
+            return std::make_pair(min_plus, max_minus);
+        }
+
         VT sum_denom;
 
         int m = num_of_hyperplanes();
 
         sum_denom = A.col(rand_coord);
-        lamdas.noalias() = b - A * r.getCoefficients();
 
         NT* lamda_data = lamdas.data();
         NT* sum_denom_data = sum_denom.data();
@@ -791,6 +884,20 @@ public:
         NT min_plus  = std::numeric_limits<NT>::max();
         NT max_minus = std::numeric_limits<NT>::lowest();
 
+        if (use_coordinate_index()) {
+            // only the slacks of the rows in the support of the previous coordinate change
+            NT step = r_prev[rand_coord_prev] - r[rand_coord_prev];
+            for (typename SparseColMT::InnerIterator it(_coord_index.cols, rand_coord_prev); it; ++it) {
+                lamdas.coeffRef(it.index()) += it.value() * step;
+            }
+            for (typename SparseColMT::InnerIterator it(_coord_index.cols, rand_coord); it; ++it) {
+                lamda = lamdas.coeff(it.index()) / it.value();
+                if (lamda < min_plus && lamda > 0) min_plus = lamda;
+                if (lamda > max_minus && lamda < 0) max_minus = lamda;
+            }
+            return std::make_pair(min_plus, max_minus);
+        }
+
         int m = num_of_hyperplanes();
 
         lamdas.noalias() += (DenseMT)(A.col(rand_coord_prev)
@@ -926,68 +1033,54 @@ public:
     std::pair<NT, int> trigonometric_positive_intersect(Point const& r, Point const& v,
                                                         NT const& omega, int &facet_prev) const
     {
-        constexpr NT pi_2 = NT(2.0) * M_PI;
-        NT t = std::numeric_limits<NT>::max();
-
-        int m = num_of_hyperplanes();
-        int facet = -1;
-
         VT sum_nom;
         VT sum_denom;
-        sum_nom.noalias() = A * r.getCoefficients();
-        sum_denom.noalias() = A * v.getCoefficients();
-
-        NT* sum_nom_data = sum_nom.data();
-        NT* sum_denom_data = sum_denom.data();
-        const NT* b_data = b.data();
-
-        const NT omega_sqr = omega * omega;
-        const NT pi_2_omega = pi_2 / omega;
-
-        for (int i = 0; i < m; i++) {
-
-            NT C = std::sqrt((*sum_nom_data) * (*sum_nom_data) + ((*sum_denom_data) * (*sum_denom_data))
-              / omega_sqr);
-            NT Phi = std::atan((-(*sum_denom_data)) / ((*sum_nom_data) * omega));
 
-            if ((*sum_denom_data) < 0.0 && Phi < 0.0) {
-                Phi += M_PI;
-            } else if ((*sum_denom_data) > 0.0 && Phi > 0.0) {
-                Phi -= M_PI;
-            }
-
-            if (C > (*b_data)) {
-                NT acos_b = std::acos((*b_data) / C);
-                NT t1 = (acos_b - Phi) / omega;
-                if (facet_prev == i && std::abs(t1) < 1e-10){
-                    t1 = pi_2_omega;
-                }
-
-                NT t2 = (-acos_b - Phi) / omega;
-                if (facet_prev == i && std::abs(t2) < 1e-10){
-                    t2 = pi_2_omega;
+        if (_facet_index.size > 0 && _facet_index.valid) {
+            facet_neighborhood const& index = _facet_index;
+            NT r_dist = (r.getCoefficients() - index.anchor).norm();
+
+            if (r_dist < index.radius) {
+                sum_nom.noalias() = index.A_near * r.getCoefficients();
+                sum_denom.noalias() = index.A_near * v.getCoefficients();
+                std::pair<NT, int> hit = trigonometric_first_hit(sum_nom, sum_denom, index.b_near,
+                                                                 omega, facet_prev, index.rows.data());
+
+                // |x'(t)|^2 + omega^2 |x(t)|^2 is constant along the trajectory, which
+                // bounds the length of the arc travelled until the hit
+                NT speed = std::sqrt(v.getCoefficients().squaredNorm()
+                                     + omega * omega * r.getCoefficients().squaredNorm());
+                if (hit.second >= 0 && r_dist + hit.first * speed < index.radius) {
+                    _facet_index.hits_since_rebuild++;
+                    num_facet_index_hits++;
+                    facet_prev = hit.second;
+                    return hit;
                 }
+            }
+        }
 
-                t1 += (t1 < NT(0)) ? pi_2_omega : NT(0);
-                t2 += (t2 < NT(0)) ? pi_2_omega : NT(0);
+        sum_nom.noalias() = A * r.getCoefficients();
+        sum_denom.noalias() = A * v.getCoefficients();
 
-                NT tmin = std::min(t1, t2);
+        std::pair<NT, int> hit = trigonometric_first_hit(sum_nom, sum_denom, b, omega, facet_prev);
+        facet_prev = hit.second;
 
-                if (tmin < t && tmin > NT(0)) {
-                    facet = i;
-                    t = tmin;
-                }
+        // the next oracle call starts close to the hit point, so the index is built around it
+        if (_facet_index.size > 0 && facet_index_rebuild_due()) {
+            if (hit.second >= 0) {
+                NT cos_t = std::cos(omega * hit.first);
+                NT sin_t = std::sin(omega * hit.first) / omega;
+                rebuild_facet_index(cos_t * r.getCoefficients() + sin_t * v.getCoefficients(),
+                                    cos_t * sum_nom + sin_t * sum_denom);
+            } else {
+                rebuild_facet_index(r.getCoefficients(), sum_nom);
             }
-
-            sum_nom_data++;
-            sum_denom_data++;
-            b_data++;
         }
-        facet_prev = facet;
-        return std::make_pair(t, facet);
+        return hit;
     }
 
 
+
     // Apply linear transformation, of square matrix T^{-1}, in H-polytope P:= Ax<=b
     template<typename T_type>
     void linear_transformIt(T_type const& T)
@@ -999,6 +1092,8 @@ public:
         }
         normalized = false;
         has_ball = false;
+        invalidate_facet_index();
+        build_coordinate_index();
     }
 
 
@@ -1008,6 +1103,7 @@ public:
     {
         b -= A*c;
         has_ball = false;
+        invalidate_facet_index();
     }
 
 
@@ -1048,6 +1144,15 @@ public:
             }
         }
         normalized = true;
+        invalidate_facet_index();
+        build_coordinate_index();
+    }
+
+    // Marks A and b as normalized without dividing them again, e.g. for rows
+    // read back from a polytope that was normalized before it was written
+    void set_normalized()
+    {
+        normalized = true;
     }
 
     void compute_reflection(Point& v, Point const&, int const& facet) const
@@ -1165,6 +1270,390 @@ public:
         return intersection_oracle.apply(t_prev, t0, eta, A, b, *this,
                                          coeffs, phi, grad_phi, ignore_facet);
     }
+
+private:
+
+    // Hit time of the trajectory A_i x(t) = C_i cos(omega t + Phi_i) with the facet A_i x <= b_i,
+    // where nom = A_i r and denom = A_i v; facets with C_i <= b_i are never hit and return the
+    // largest NT. The result is a valid hit only if it is positive.
+    static NT trigonometric_facet_hit(NT const& nom, NT const& denom, NT const& b_i,
+                                      NT const& omega, bool const& is_facet_prev)
+    {
+        const NT pi_2_omega = (NT(2.0) * M_PI) / omega;
+
+        // the test is done on C_i^2, so sqrt, atan and acos are evaluated only if it passes
+        NT C_sqr = nom * nom + (denom * denom) / (omega * omega);
+        if (!(b_i < NT(0) || C_sqr > b_i * b_i)) {
+            return std::numeric_limits<NT>::max();
+        }
+
+        NT Phi = std::atan((-denom) / (nom * omega));
+        if (denom < 0.0 && Phi < 0.0) {
+            Phi += M_PI;
+        } else if (denom > 0.0 && Phi > 0.0) {
+            Phi -= M_PI;
+        }
+
+        NT acos_b = std::acos(b_i / std::sqrt(C_sqr));
+        NT t1 = (acos_b - Phi) / omega;
+        if (is_facet_prev && std::abs(t1) < 1e-10){
+            t1 = pi_2_omega;
+        }
+
+        NT t2 = (-acos_b - Phi) / omega;
+        if (is_facet_prev && std::abs(t2) < 1e-10){
+            t2 = pi_2_omega;
+        }
+
+        t1 += (t1 < NT(0)) ? pi_2_omega : NT(0);
+        t2 += (t2 < NT(0)) ? pi_2_omega : NT(0);
+
+        return std::min(t1, t2);
+    }
+
+    // Buffers of one block of facets of the vectorized trigonometric oracle. Keeping
+    // them in one local struct lets the compiler see that they do not alias, so the
+    // loops over a block are vectorized.
+    static constexpr int trigonometric_block_size = 64;
+    struct trigonometric_block
+    {
+        NT nom[trigonometric_block_size];
+        NT denom[trigonometric_block_size];
+        NT b[trigonometric_block_size];
+        NT C_sqr[trigonometric_block_size];
+        NT y[trigonometric_block_size];
+        NT sqrt_y[trigonometric_block_size];
+        NT t_approx[trigonometric_block_size];
+        NT t_candidate[trigonometric_block_size];
+    };
+
+    // Approximate hit times of the facets of a block. Phi and acos(b_i / C_i) are computed
+    // with the polynomial approximations 4.4.49 and 4.4.46 of Abramowitz and Stegun, whose
+    // error is below 2e-8, so the exact hit time of facet k is within eps_t of the
+    // approximate one. t_approx[k] is the approximate hit time, -1 if the facet has to be
+    // evaluated exactly and infinity if it is never hit; t_candidate[k] is the approximate
+    // hit time only if the exact one is a valid hit (and infinity otherwise). The loop
+    // only selects between values that are already computed (hence also & instead of &&),
+    // so that it is if-converted and vectorized.
+    static void trigonometric_block_bounds(trigonometric_block& block, int n, NT omega, NT eps_t)
+    {
+        typedef Eigen::Map<Eigen::Array<NT, Eigen::Dynamic, 1>> BlockArray;
+        const NT pi_2_omega = (NT(2.0) * M_PI) / omega;
+        const NT inf = std::numeric_limits<NT>::infinity();
+
+        BlockArray(block.y, n) = (BlockArray(block.b, n) / BlockArray(block.C_sqr, n).sqrt())
+                                 .max(NT(-1)).min(NT(1));
+        BlockArray(block.sqrt_y, n) = (NT(1) - BlockArray(block.y, n).abs()).sqrt();
+
+        for (int k = 0; k < n; k++) {
+            // atan(|z|) = pi/4 + atan((|z| - 1) / (|z| + 1)) and the sign of Phi is the sign of z
+            NT z = (-block.denom[k]) / (block.nom[k] * omega);
+            NT az = std::abs(z);
+            NT w = (az - NT(1)) / (az + NT(1));
+            NT w2 = w * w;
+            NT atan_az = NT(M_PI_4) + w * (NT(1) + w2 * (NT(-0.3333314528) + w2 * (NT(0.1999355085)
+                         + w2 * (NT(-0.1420889944) + w2 * (NT(0.1065626393) + w2 * (NT(-0.0752896400)
+                         + w2 * (NT(0.0429096138) + w2 * (NT(-0.0161657367) + w2 * NT(0.0028662257)))))))));
+            NT Phi = std::copysign(atan_az, z);
+            NT Phi_plus = ((block.denom[k] < NT(0)) & (z < NT(0))) ? NT(M_PI) : NT(0);
+            NT Phi_minus = ((block.denom[k] > NT(0)) & (z > NT(0))) ? NT(M_PI) : NT(0);
+            Phi += Phi_plus - Phi_minus;
+
+            // acos(y) = pi/2 - asin(y) and asin is odd
+            NT ay = std::abs(block.y[k]);
+            NT acos_ay = block.sqrt_y[k] * (NT(1.5707963050) + ay * (NT(-0.2145988016)
+                         + ay * (NT(0.0889789874) + ay * (NT(-0.0501743046) + ay * (NT(0.0308918810)
+                         + ay * (NT(-0.0170881256) + ay * (NT(0.0066700901) + ay * NT(-0.0012624911))))))));
+            NT acos_b = NT(M_PI_2) - std::copysign(NT(M_PI_2) - acos_ay, block.y[k]);
+
+            NT t1 = (acos_b - Phi) / omega;
+            NT t2 = (-acos_b - Phi) / omega;
+
+            // close to 0 the exact hit time may be on the other side of the wrap around
+            NT at1 = std::abs(t1);
+            NT at2 = std::abs(t2);
+            NT dist_zero = (at2 < at1) ? at2 : at1;
+            t1 += (t1 < NT(0)) ? pi_2_omega : NT(0);
+            t2 += (t2 < NT(0)) ? pi_2_omega : NT(0);
+            NT tmin = (t2 < t1) ? t2 : t1;
+
+            // a NaN (e.g. for nom = 0) is kept in t_approx and evaluated exactly
+            NT approx_hit = (dist_zero <= eps_t) ? NT(-1) : tmin;
+            NT candidate_hit = (dist_zero <= eps_t) ? inf : tmin;
+            NT approx_other = (block.b[k] < NT(0)) ? NT(-1) : inf;
+            bool hit = block.C_sqr[k] > block.b[k] * block.b[k];
+            block.t_approx[k] = hit ? approx_hit : approx_other;
+            block.t_candidate[k] = hit ? candidate_hit : inf;
+        }
+    }
+
+    // first positive hit of the trajectory A_i x(t) = C_i cos(omega t + Phi_i) with the
+    // facets A_i x <= b_i, where sum_nom = A r and sum_denom = A v; if rows is given,
+    // the i-th row of the system is the facet rows[i] of the polytope
+    std::pair<NT, int> trigonometric_first_hit(VT const& sum_nom, VT const& sum_denom, VT const& b_vec,
+                                               NT const& omega, int const& facet_prev,
+                                               const int* rows = nullptr) const
+    {
+        NT t = std::numeric_limits<NT>::max();
+        int m = sum_nom.size();
+        int facet = -1;
+
+        const NT* sum_nom_data = sum_nom.data();
+        const NT* sum_denom_data = sum_denom.data();
+        const NT* b_data = b_vec.data();
+
+        if (!_vectorized_trigonometric_oracle) {
+            for (int i = 0; i < m; i++) {
+                int row = (rows == nullptr) ? i : rows[i];
+                NT tmin = trigonometric_facet_hit(sum_nom_data[i], sum_denom_data[i], b_data[i],
+                                                  omega, facet_prev == row);
+                if (tmin < t && tmin > NT(0)) {
+                    facet = row;
+                    t = tmin;
+                }
+            }
+            return std::make_pair(t, facet);
+        }
+
+        // The facets are scanned in blocks. The exact hit time of a facet is within eps_t of
+        // its approximate one, so a facet can be hit first only if its approximate hit time
+        // is at most eps_t after the best exact hit found so far and at most 2 eps_t after
+        // the smallest candidate hit of the block. Only those facets are evaluated exactly,
+        // in the order of the scalar loop, so the result is the same as the one of the
+        // scalar loop.
+        const NT eps_t = std::max(NT(1e-6), NT(1000) * std::numeric_limits<NT>::epsilon()) / omega;
+        const NT omega_sqr = omega * omega;
+        trigonometric_block block;
+
+        for (int start = 0; start < m; start += trigonometric_block_size) {
+            int n = std::min(trigonometric_block_size, m - start);
+            const NT* nom = sum_nom_data + start;
+            const NT* denom = sum_denom_data + start;
+            const NT* b_i = b_data + start;
+
+            int num_candidates = 0;
+            for (int k = 0; k < n; k++) {
+                block.C_sqr[k] = nom[k] * nom[k] + (denom[k] * denom[k]) / omega_sqr;
+                num_candidates += ((b_i[k] < NT(0)) | (block.C_sqr[k] > b_i[k] * b_i[k])) ? 1 : 0;
+            }
+            if (num_candidates == 0) {
+                continue;
+            }
+
+            // with few candidates the approximations do not pay off
+            if (num_candidates <= n / 16) {
+                for (int k = 0; k < n; k++) {
+                    if (b_i[k] < NT(0) || block.C_sqr[k] > b_i[k] * b_i[k]) {
+                        int row = (rows == nullptr) ? start + k : rows[start + k];
+                        NT tmin = trigonometric_facet_hit(nom[k], denom[k], b_i[k], omega, facet_prev == row);
+                        if (tmin < t && tmin > NT(0)) {
+                            facet = row;
+                            t = tmin;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            std::copy(nom, nom + n, block.nom);
+            std::copy(denom, denom + n, block.denom);
+            std::copy(b_i, b_i + n, block.b);
+            trigonometric_block_bounds(block, n, omega, eps_t);
+
+            // the previous facet is special cased in the exact evaluation
+            for (int k = 0; k < n; k++) {
+                int row = (rows == nullptr) ? start + k : rows[start + k];
+                if (row == facet_prev) {
+                    block.t_approx[k] = NT(-1);
+                    block.t_candidate[k] = std::numeric_limits<NT>::infinity();
+                }
+            }
+
+            NT min_candidate = Eigen::Map<Eigen::Array<NT, Eigen::Dynamic, 1>>(block.t_candidate, n).minCoeff();
+            NT threshold = std::min(t + eps_t, min_candidate + NT(2) * eps_t);
+            for (int k = 0; k < n; k++) {
+                if (!(block.t_approx[k] > threshold)) {
+                    int row = (rows == nullptr) ? start + k : rows[start + k];
+                    NT tmin = trigonometric_facet_hit(nom[k], denom[k], b_i[k], omega, facet_prev == row);
+                    if (tmin < t && tmin > NT(0)) {
+                        facet = row;
+                        t = tmin;
+                        threshold = std::min(threshold, t + eps_t);
+                    }
+                }
+            }
+        }
+        return std::make_pair(t, facet);
+    }
+
+
+    // scan only the facets of the neighborhood index for the first hit of the ray r + tv;
+    // returns false if the index cannot prove that no other facet is hit first
+    bool line_positive_intersect_near(Point const& r, Point const& v, std::pair<NT, int>& hit) const
+    {
+        facet_neighborhood const& index = _facet_index;
+        if (!index.valid) {
+            return false;
+        }
+
+        NT r_dist = (r.getCoefficients() - index.anchor).norm();
+        if (r_dist >= index.radius) {
+            return false;
+        }
+
+        VT sum_nom = index.b_near - index.A_near * r.getCoefficients();
+        VT Av_near = index.A_near * v.getCoefficients();
+
+        NT min_plus = std::numeric_limits<NT>::max();
+        int facet = -1;
+
+        const NT* Av_data = Av_near.data();
+        const NT* sum_nom_data = sum_nom.data();
+
+        for (int i = 0; i < Av_near.size(); ++i, ++Av_data, ++sum_nom_data) {
+            if (*Av_data == NT(0)) continue;
+            NT lamda = *sum_nom_data / *Av_data;
+            if (lamda < min_plus && lamda > 0) {
+                min_plus = lamda;
+                facet = i;
+            }
+        }
+
+        // the segment [r, r + min_plus * v] lies in the ball around the anchor iff its endpoints do
+        if (facet < 0 || (r.getCoefficients() + min_plus * v.getCoefficients()
+                          - index.anchor).norm() >= index.radius) {
+            return false;
+        }
+
+        hit = std::make_pair(min_plus, _facet_index.rows[facet]);
+        _facet_index.hits_since_rebuild++;
+        num_facet_index_hits++;
+        return true;
+    }
+
+
+    // if lambda_prev is given and the previous call was a full scan, Ar is updated
+    // incrementally as in line_intersect
+    std::pair<NT, int> indexed_line_positive_intersect(Point const& r,
+                                                       Point const& v,
+                                                       VT& Ar,
+                                                       VT& Av,
+                                                       NT const* lambda_prev = nullptr) const
+    {
+        std::pair<NT, int> hit;
+        if (line_positive_intersect_near(r, v, hit)) {
+            _facet_index.stale_products = true;
+            return hit;
+        }
+        if (lambda_prev != nullptr && !_facet_index.stale_products) {
+            hit = line_intersect(r, v, Ar, Av, *lambda_prev, true);
+        } else {
+            hit = line_intersect(r, v, Ar, Av, true);
+        }
+        _facet_index.stale_products = false;
+
+        // the next oracle call starts close to the hit point, so the index is built around it
+        if (!facet_index_rebuild_due()) {
+            return hit;
+        }
+        if (hit.first < std::numeric_limits<NT>::max()) {
+            rebuild_facet_index(r.getCoefficients() + hit.first * v.getCoefficients(),
+                                Ar + hit.first * Av);
+        } else {
+            rebuild_facet_index(r.getCoefficients(), Ar);
+        }
+        return hit;
+    }
+
+
+    // called on every full scan; if the index did not answer any call since it was
+    // built, the next rebuilds are delayed exponentially to bound the overhead on
+    // bodies where trajectories do not stay local
+    bool facet_index_rebuild_due() const
+    {
+        facet_neighborhood& index = _facet_index;
+        if (index.valid) {
+            index.backoff = (index.hits_since_rebuild > 0) ? 0 : std::min(2 * index.backoff + 1, 63u);
+            index.skip = index.backoff;
+            index.valid = false;
+        }
+        if (index.skip > 0) {
+            index.skip--;
+            return false;
+        }
+        return true;
+    }
+
+
+    // keep the facets closest to the anchor point x, given Ax = A * x
+    void rebuild_facet_index(VT const& x, VT const& Ax) const
+    {
+        facet_neighborhood& index = _facet_index;
+        int m = num_of_hyperplanes();
+
+        if (index.row_norms.size() != m) {
+            index.row_norms.resize(m);
+            for (int i = 0; i < m; ++i) {
+                index.row_norms(i) = A.row(i).norm();
+            }
+        }
+
+        VT dists = (b - Ax).cwiseQuotient(index.row_norms);
+        int k = std::min(int(index.size), m);
+
+        std::vector<int> order(m);
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + (k < m ? k : m - 1), order.end(),
+                         [&dists](int i, int j) { return dists(i) < dists(j); });
+
+        index.radius = (k < m) ? dists(order[k]) : std::numeric_limits<NT>::max();
+        index.rows.assign(order.begin(), order.begin() + k);
+        std::sort(index.rows.begin(), index.rows.end());
+
+        index.A_near.resize(k, _d);
+        index.b_near.resize(k);
+        for (int i = 0; i < k; ++i) {
+            index.A_near.row(i) = A.row(index.rows[i]);
+            index.b_near(i) = b(index.rows[i]);
+        }
+        index.anchor = x;
+        index.valid = true;
+        index.hits_since_rebuild = 0;
+        num_facet_index_rebuilds++;
+    }
+
+
+    void invalidate_facet_index()
+    {
+        _facet_index.valid = false;
+        _facet_index.row_norms.resize(0);
+    }
+
+    bool use_coordinate_index() const
+    {
+        return _coord_index.use;
+    }
+
+    // Rebuild the column index of the coordinate oracles. A sparse MT always uses it;
+    // a dense MT only when at most a quarter of the entries of A are nonzero.
+    void build_coordinate_index()
+    {
+        _coord_index = coordinate_index();
+        if (A.rows() == 0) {
+            return;
+        }
+        if constexpr (std::is_same<MT, DenseMT>::value) {
+            Eigen::Index nnz = (A.array() != NT(0)).count();
+            _coord_index.use = 4 * nnz <= A.rows() * A.cols();
+            if (_coord_index.use) {
+                _coord_index.cols = A.sparseView();
+            }
+        } else {
+            _coord_index.use = true;
+            _coord_index.cols = A;
+        }
+        _coord_index.cols.makeCompressed();
+    }
 };
 
 #endif
\ No newline at end of file
@@ -37,9 +37,46 @@ private:
     VT _row_norms;
     MT _A;  // representing as Ax <= b for ComputeInnerBall and printing
 
+    // indices of the order relations that involve each element
+    std::vector<std::vector<unsigned int>> _incident_relations;
+
     unsigned int _num_hyperplanes;
     bool _normalized;
 
+    // coefficient of the element k in the row of the relation idx
+    NT relation_coeff(unsigned int idx, unsigned int k) const
+    {
+        NT a = (_poset.get_relation(idx).first == k) ? NT(1) : NT(-1);
+        return _normalized ? a / _row_norms(2*_d + idx) : a;
+    }
+
+    // Intersection of the coordinate ray of the element k with the order polytope,
+    // given the slacks b - Ar. Only the 2 bound rows of k and the relations that
+    // involve k depend on the coordinate k
+    std::pair<NT,NT> coord_intersect(unsigned int const& k, VT const& lamdas) const
+    {
+        NT min_plus  = std::numeric_limits<NT>::max();
+        NT max_minus = std::numeric_limits<NT>::lowest();
+
+        auto update = [&](NT const& a, NT const& slack) {
+            NT lamda = slack / a;
+            if (lamda < min_plus && lamda > 0) {
+                min_plus = lamda;
+            }
+            else if (lamda > max_minus && lamda < 0) {
+                max_minus = lamda;
+            }
+        };
+
+        update(NT(-1), lamdas(k));
+        update(NT(1), lamdas(_d + k));
+        for (unsigned int idx : _incident_relations[k]) {
+            update(relation_coeff(idx, k), lamdas(2*_d + idx));
+        }
+
+        return std::make_pair(min_plus, max_minus);
+    }
+
 public:
     OrderPolytope(Poset const& poset) : _poset(poset)
     {
@@ -58,10 +95,13 @@ public:
 
         // next add the relations
         unsigned int num_relations = _poset.num_relations();
+        _incident_relations.resize(_d);
         for(int idx=0; idx<num_relations; ++idx) {
             std::pair<unsigned int, unsigned int> curr_relation = _poset.get_relation(idx);
             _A(2*_d + idx, curr_relation.first)  = 1;
             _A(2*_d + idx, curr_relation.second) = -1;
+            _incident_relations[curr_relation.first].push_back(idx);
+            _incident_relations[curr_relation.second].push_back(idx);
         }
         _row_norms.block(2*_d, 0, num_relations, 1) = Eigen::MatrixXd::Constant(num_relations, 1, sqrt(2));
 
@@ -556,88 +596,34 @@ public:
     //------------------------------------------------------------------------------//
 
 
-    // TODO: This can be removed as only modified Accelerated Billiard Walk will be used with Order Polytope
     // Compute the intersection of a coordinate ray
     // with the order polytope
     std::pair<NT,NT> line_intersect_coord(Point const& r,
                                           unsigned int const& rand_coord,
                                           VT& lamdas) const
     {
-        NT lamda = 0;
-        NT min_plus  = std::numeric_limits<NT>::max();
-        NT max_minus = std::numeric_limits<NT>::lowest();
-        VT sum_denom;
-
-        int rows = num_of_hyperplanes();
-
-        sum_denom = get_col(rand_coord);
         lamdas = b - vec_mult(r.getCoefficients());
-
-        NT* sum_nom_data = lamdas.data();
-        NT* sum_denom_data = sum_denom.data();
-
-        // iterate over all hyperplanes
-        for(unsigned int i = 0; i<rows; ++i) {
-            if (*sum_denom_data == NT(0)) {
-                // throw std::runtime_error("Error: division by 0");
-            } else {
-                lamda = *sum_nom_data / *sum_denom_data;
-                if (lamda < min_plus && lamda > 0) {
-                    min_plus = lamda;
-                }
-                else if (lamda > max_minus && lamda < 0) {
-                    max_minus = lamda;
-                }
-            }
-
-            sum_nom_data++;
-            sum_denom_data++;
-        }
-
-        return std::make_pair(min_plus, max_minus);
+        return coord_intersect(rand_coord, lamdas);
     }
 
 
-    // TODO: This can be removed as only modified Accelerated Billiard Walk will be used with Order Polytope
+    // Same as above, updating the slacks of the previous step. Both the update
+    // and the intersection cost O(number of relations of the two elements)
     std::pair<NT,NT> line_intersect_coord(Point const& r,
                                           Point const& r_prev,
                                           unsigned int const& rand_coord,
                                           unsigned int const& rand_coord_prev,
                                           VT& lamdas) const
     {
-        NT lamda = 0;
-        NT min_plus  = std::numeric_limits<NT>::max();
-        NT max_minus = std::numeric_limits<NT>::lowest();
-
-        int rows = num_of_hyperplanes();
-
-        lamdas.noalias() += get_col(rand_coord_prev)
-                        * (r_prev[rand_coord_prev] - r[rand_coord_prev]);
-        NT* sum_nom_data = lamdas.data();
+        NT delta = r_prev[rand_coord_prev] - r[rand_coord_prev];
 
-        // iterate over all hyperplanes
-        for(unsigned int i = 0; i<rows; ++i) {
-            NT a = _A(i, rand_coord);
-            if(_normalized) {
-                a = a / _row_norms(i);
-            }
-
-            if (a == NT(0)) {
-                // throw std::runtime_error("Error: division by 0");
-            } else {
-                lamda = *sum_nom_data / a;
-                if (lamda < min_plus && lamda > 0) {
-                    min_plus = lamda;
-                }
-                else if (lamda > max_minus && lamda < 0) {
-                    max_minus = lamda;
-                }
-            }
-
-            sum_nom_data++;
+        lamdas(rand_coord_prev) -= delta;
+        lamdas(_d + rand_coord_prev) += delta;
+        for (unsigned int idx : _incident_relations[rand_coord_prev]) {
+            lamdas(2*_d + idx) += relation_coeff(idx, rand_coord_prev) * delta;
         }
 
-        return std::make_pair(min_plus, max_minus);
+        return coord_intersect(rand_coord, lamdas);
     }
 
 
@@ -0,0 +1,165 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2020 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef VOLESTI_BLOCK_LMI_H
+#define VOLESTI_BLOCK_LMI_H
+
+#include "LMI.h"
+
+
+/// This class handles a block diagonal linear matrix inequality \[A_0 + \sum x_i A_i\],
+/// where every A_i = diag(A_i^1, ..., A_i^k). Each block is stored as a separate LMI
+/// over the variables x_i with A_i^j != 0, so evaluating a block costs only the
+/// variables that appear in it and we never form the full block diagonal matrix.
+/// @tparam NT Numeric Type
+/// @tparam MT Matrix Type
+/// @tparam VT Vector Type
+template<typename NT, typename MT, typename VT>
+class BlockLMI {
+    public:
+
+    /// The LMI of each block, over the local variables of the block
+    std::vector<LMI<NT, MT, VT>> blocks;
+
+    /// The (global) indices of the variables of each block
+    std::vector<std::vector<int>> variables;
+
+    /// The dimension of the vector x
+    unsigned int d;
+
+    BlockLMI(){}
+
+    /// Creates a block diagonal LMI
+    /// \param[in] block_matrices block_matrices[i][j] is the j-th block of A_i, i = 0, ..., d
+    BlockLMI(std::vector<std::vector<MT>> const& block_matrices) {
+        d = block_matrices.size() - 1;
+        int num_blocks = block_matrices[0].size();
+
+        for (int j = 0; j < num_blocks; j++) {
+            std::vector<MT> matrices;
+            std::vector<int> vars;
+
+            matrices.push_back(block_matrices[0][j]);
+            for (int i = 1; i <= d; i++) {
+                if (!block_matrices[i][j].isZero(0)) {
+                    matrices.push_back(block_matrices[i][j]);
+                    vars.push_back(i - 1);
+                }
+            }
+
+            // a block that does not depend on x is a constant constraint
+            if (vars.empty()) continue;
+
+            blocks.push_back(LMI<NT, MT, VT>(matrices));
+            variables.push_back(vars);
+        }
+    }
+
+    /// \returns The dimension of vector x
+    unsigned int dimension() const {
+        return d;
+    }
+
+    /// \returns The number of blocks
+    unsigned int numBlocks() const {
+        return blocks.size();
+    }
+
+    /// \returns The size of the j-th block
+    unsigned int sizeOfBlock(int const j) const {
+        return blocks[j].sizeOfMatrices();
+    }
+
+    /// \returns The total size of the block diagonal matrices
+    unsigned int sizeOfMatrices() const {
+        unsigned int m = 0;
+        for (auto const& block : blocks) m += block.sizeOfMatrices();
+        return m;
+    }
+
+    /// \returns The variables of x that appear in the j-th block
+    std::vector<int> const& blockVariables(int const j) const {
+        return variables[j];
+    }
+
+    /// \returns The LMI of the j-th block
+    LMI<NT, MT, VT> const& getBlock(int const j) const {
+        return blocks[j];
+    }
+
+    /// \param[in] x The input vector
+    /// \param[in] j The index of a block
+    /// \return The coordinates of x that appear in the j-th block
+    VT localVector(VT const& x, int const j) const {
+        VT x_j(variables[j].size());
+        for (int i = 0; i < variables[j].size(); i++) {
+            x_j(i) = x(variables[j][i]);
+        }
+        return x_j;
+    }
+
+    /// Evaluate the j-th block \[A_0^j + \sum x_i A_i^j \]
+    /// \param[in] x The input vector
+    /// \param[in] j The index of the block
+    /// \param[out] ret The output matrix
+    void evaluate(VT const& x, int const j, MT& ret, bool complete_mat = false) const {
+        ret.resize(sizeOfBlock(j), sizeOfBlock(j));
+        blocks[j].evaluate(localVector(x, j), ret, complete_mat);
+    }
+
+    /// Compute the j-th block \[\sum x_i A_i^j \]
+    /// \param[in] x The input vector
+    /// \param[in] j The index of the block
+    /// \param[out] ret The output matrix
+    void evaluateWithoutA0(VT const& x, int const j, MT& ret, bool complete_mat = false) const {
+        ret.resize(sizeOfBlock(j), sizeOfBlock(j));
+        blocks[j].evaluateWithoutA0(localVector(x, j), ret, complete_mat);
+    }
+
+    /// Compute the normalized gradient of the determinant of the j-th block at a boundary point
+    /// \param[in] j The index of the block that is singular at the boundary point
+    /// \param[in] e Input vector: lmi_j(p)*e = 0, e != 0
+    /// \param[out] ret The normalized gradient
+    void normalizedDeterminantGradient(int const j, VT const& e, VT &ret) const {
+        std::vector<MT> const& matrices = blocks[j].matrices;
+        ret.setZero(d);
+        NT sum_sq = NT(0);
+
+        for (int i = 0; i < variables[j].size(); i++) {
+            NT val = e.dot(matrices[i+1].template selfadjointView< Eigen::Lower >() * e);
+            ret(variables[j][i]) = val;
+            sum_sq += val * val;
+        }
+
+        ret /= std::sqrt(sum_sq);
+    }
+
+    /// Shift the LMI, i.e. replace A_0 with A_0 + \sum e_i A_i
+    void shift(VT const& e) {
+        for (int j = 0; j < blocks.size(); j++) {
+            MT A0_j;
+            evaluate(e, j, A0_j, true);
+            blocks[j].set_A0(A0_j);
+        }
+    }
+
+    /// evaluate LMI(pos) and check if it is negative semidefinite, block by block
+    /// \param pos a vector of our current position
+    /// \return true if LMI(pos) is negative semidefinite
+    bool isNegativeSemidefinite(VT const & pos) const {
+        for (int j = 0; j < blocks.size(); j++) {
+            MT mat;
+            evaluate(pos, j, mat, true);
+            Eigen::LDLT<MT> mat_ldlt(-mat);
+            if (mat_ldlt.info() == Eigen::NumericalIssue || !mat_ldlt.isPositive())
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif //VOLESTI_BLOCK_LMI_H
@@ -0,0 +1,405 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2020 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef VOLESTI_BLOCK_SPECTRAHEDRON_H
+#define VOLESTI_BLOCK_SPECTRAHEDRON_H
+
+#include "block_LMI.h"
+
+
+/// Among successive calls of the BlockSpectrahedron methods we keep, for every block,
+/// the matrices of the linear eigenvalue problem and the eigenvector of the last call
+template <typename NT, typename MT, typename VT>
+struct BlockPrecomputationOfValues {
+
+    /// If true, the matrices C_j = lmi_j(p) are up to date and are not recomputed
+    bool computed_C = false;
+
+    /// C_j = lmi_j(p), B_j = lmi_j(v) - A0_j for each block j
+    std::vector<MT> B, C;
+
+    /// The eigenvector of the last linear eigenvalue problem of each block
+    std::vector<VT> eigenvector;
+
+    /// The distance to the boundary of each block along the last direction
+    std::vector<NT> distances;
+
+    /// The block that defines the boundary point of the last call
+    int hit_block = -1;
+
+    void resetFlags() {
+        computed_C = false;
+    }
+
+    template <typename BlockLMIType>
+    void set_mat_size(BlockLMIType const& lmi)
+    {
+        int num_blocks = lmi.numBlocks();
+        B.resize(num_blocks);
+        C.resize(num_blocks);
+        eigenvector.resize(num_blocks);
+        distances.resize(num_blocks);
+
+        for (int j = 0; j < num_blocks; j++) {
+            int m = lmi.sizeOfBlock(j);
+            B[j].setZero(m, m);
+            C[j].setZero(m, m);
+            eigenvector[j].setZero(m);
+        }
+    }
+};
+
+
+/// This class manipulates a spectrahedron described by a block diagonal LMI.
+/// The boundary oracles are computed block by block and the result is the minimum
+/// over the blocks. Blocks are processed in parallel with OpenMP (if enabled).
+/// \tparam Point Point Type
+template<typename Point>
+class BlockSpectrahedron {
+public:
+
+    /// The numeric/matrix/vector types we use
+    typedef Point                                             PointType;
+    typedef typename Point::FT                                NT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1>              VT;
+
+    double maxDouble = std::numeric_limits<double>::max();
+
+    /// Blocks up to this size are solved with a dense generalized eigensolver,
+    /// larger ones with Spectra
+    unsigned int dense_block_size = 30;
+
+    typedef BlockPrecomputationOfValues<NT, MT, VT> _PrecomputationOfValues;
+
+    _PrecomputationOfValues precomputedValues;
+
+    EigenvaluesProblems<NT, MT, VT> EigenvaluesProblem;
+
+    /// The dimension of the spectrahedron
+    unsigned int d;
+    std::pair<PointType, NT> _inner_ball;
+
+    /// The block diagonal linear matrix inequality that describes the spectrahedron
+    BlockLMI<NT, MT, VT> lmi;
+
+    BlockSpectrahedron() {}
+
+    /// Creates a spectrahedron
+    /// \param[in] lmi The block diagonal linear matrix inequality that describes the spectrahedron
+    BlockSpectrahedron(const BlockLMI<NT, MT, VT>& lmi) : lmi(lmi) {
+        d = lmi.dimension();
+        precomputedValues.resetFlags();
+        precomputedValues.set_mat_size(this->lmi);
+        _inner_ball.first = PointType(d);
+    }
+
+    void set_interior_point(PointType const& r)
+    {
+        _inner_ball.first = r;
+    }
+
+    std::pair<PointType, NT> ComputeInnerBall() {
+        NT radius = maxDouble;
+
+        for (unsigned int i = 0; i < dimension(); ++i) {
+
+            std::pair<NT, NT> min_max = coordinateIntersection(_inner_ball.first.getCoefficients(), i+1);
+
+            if (min_max.first < radius) radius = min_max.first;
+            if (-min_max.second < radius) radius = -min_max.second;
+        }
+
+        radius = radius / std::sqrt(NT(dimension()));
+        _inner_ball.second = radius;
+
+        return std::pair<PointType, NT>(_inner_ball.first, radius);
+    }
+
+    std::pair<Point,NT> InnerBall() const
+    {
+        return _inner_ball;
+    }
+
+    /// Computes the smallest t > 0 such that C + tB is singular, where C is negative definite.
+    /// \param[in] C Input matrix
+    /// \param[in] B Input matrix
+    /// \param[out] eigvec The vector in the kernel of C + tB
+    /// \return The distance t, or maxDouble if C + tB is negative definite for every t > 0
+    NT blockPositiveIntersection(MT const& C, MT const& B, VT &eigvec) const
+    {
+        NT lambda;
+        int m = C.rows();
+
+        if (m == 1) {
+            if (B(0, 0) <= NT(0)) return maxDouble;
+            eigvec.setOnes(1);
+            return -C(0, 0) / B(0, 0);
+        }
+
+        if (m <= dense_block_size) {
+            // largest eigenvalue of Bx = l(-C)x
+            Eigen::GeneralizedSelfAdjointEigenSolver<MT> ges(B, -C);
+            lambda = ges.eigenvalues()(m - 1);
+            if (lambda <= NT(0)) return maxDouble;
+            eigvec = ges.eigenvectors().col(m - 1);
+            return NT(1) / lambda;
+        }
+
+        NT distance = EigenvaluesProblem.minPosLinearEigenvalue(C, B, eigvec);
+        return (distance > NT(0)) ? distance : maxDouble;
+    }
+
+    /// Computes the distance we must travel on the line p + tv, t > 0, before reaching the boundary.
+    /// The distance is the minimum over the blocks; the index of the block that attains it is kept
+    /// for the reflection.
+    NT positiveLinearIntersection(VT const & p, VT const & v)
+    {
+        int num_blocks = lmi.numBlocks();
+
+        #pragma omp parallel for
+        for (int j = 0; j < num_blocks; j++) {
+            if (!precomputedValues.computed_C) {
+                lmi.evaluate(p, j, precomputedValues.C[j], true);
+            }
+            lmi.evaluateWithoutA0(v, j, precomputedValues.B[j], true);
+            precomputedValues.distances[j] = blockPositiveIntersection(precomputedValues.C[j],
+                                                                       precomputedValues.B[j],
+                                                                       precomputedValues.eigenvector[j]);
+        }
+
+        NT distance = maxDouble;
+        precomputedValues.hit_block = -1;
+        for (int j = 0; j < num_blocks; j++) {
+            if (precomputedValues.distances[j] < distance) {
+                distance = precomputedValues.distances[j];
+                precomputedValues.hit_block = j;
+            }
+        }
+
+        return distance;
+    }
+
+    /// Computes the distance one must travel on the line a + te_i before reaching the boundary,
+    /// assuming we start at t=0, in the positive and the negative direction.
+    /// Only the blocks that depend on the i-th variable restrict the line.
+    /// \param[in] a Input vector
+    /// \param[in] coordinate Indicator of the i-th coordinate, 1 <= coordinate <= dimension
+    /// \return The pair (positive t, negative t) for which we reach the boundary
+    std::pair<NT, NT> coordinateIntersection(VT const & a, int const coordinate) {
+        VT e = VT::Zero(d);
+        e(coordinate - 1) = NT(1);
+
+        NT pos = maxDouble, neg = -maxDouble;
+        VT eigvec;
+
+        for (int j = 0; j < lmi.numBlocks(); j++) {
+            std::vector<int> const& vars = lmi.blockVariables(j);
+            if (std::find(vars.begin(), vars.end(), coordinate - 1) == vars.end()) continue;
+
+            MT C, B;
+            lmi.evaluate(a, j, C, true);
+            lmi.evaluateWithoutA0(e, j, B, true);
+
+            pos = std::min(pos, blockPositiveIntersection(C, B, eigvec));
+            neg = std::max(neg, -blockPositiveIntersection(C, MT(-B), eigvec));
+        }
+
+        return std::make_pair(pos, neg);
+    }
+
+    //First coordinate ray intersecting convex polytope
+    std::pair<NT,NT> line_intersect_coord(Point &r,
+                                          unsigned int const& rand_coord,
+                                          VT&)
+    {
+        return coordinateIntersection(r.getCoefficients(), rand_coord + 1);
+    }
+
+    //Not the first coordinate ray intersecting convex
+    std::pair<NT,NT> line_intersect_coord(PointType &r,
+                                          PointType&,
+                                          unsigned int const& rand_coord,
+                                          unsigned int&,
+                                          VT&)
+    {
+        return coordinateIntersection(r.getCoefficients(), rand_coord + 1);
+    }
+
+    // compute intersection point of a ray starting from r and pointing to v
+    std::pair<NT, int> line_positive_intersect(PointType const& r,
+                                               PointType const& v)
+    {
+        NT pos_inter = positiveLinearIntersection(r.getCoefficients(), v.getCoefficients());
+        return std::pair<NT, int> (pos_inter, -1);
+    }
+
+    std::pair<NT, int> line_positive_intersect(PointType const& r,
+                                               PointType const& v,
+                                               VT&,
+                                               VT& ,
+                                               NT const&) {
+        return line_positive_intersect(r, v);
+    }
+
+    template <typename update_parameters>
+    std::pair<NT, int> line_positive_intersect(PointType const& r,
+                                               PointType const& v,
+                                               VT&,
+                                               VT& ,
+                                               NT const&,
+                                               update_parameters&)
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    template <typename update_parameters>
+    std::pair<NT, int> line_positive_intersect(PointType const& r,
+                                               PointType const& v,
+                                               VT&,
+                                               VT&,
+                                               NT const&,
+                                               MT const&,
+                                               update_parameters& )
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    template <typename update_parameters>
+    std::pair<NT, int> line_first_positive_intersect(PointType const& r,
+                                                     PointType const& v,
+                                                     VT&,
+                                                     VT&,
+                                                     update_parameters&)
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    std::pair<NT, int> line_positive_intersect(PointType const& r,
+                                               PointType const& v,
+                                               VT&,
+                                               VT&)
+    {
+        return line_positive_intersect(r, v);
+    }
+
+    // compute intersection points of the line r + tv with the boundary
+    std::pair<NT,NT> line_intersect(PointType const& r, PointType const& v)
+    {
+        precomputedValues.computed_C = false;
+        NT pos_inter = positiveLinearIntersection(r.getCoefficients(), v.getCoefficients());
+        precomputedValues.computed_C = true;
+        NT neg_inter = -positiveLinearIntersection(r.getCoefficients(), NT(-1)*v.getCoefficients());
+        precomputedValues.computed_C = false;
+
+        return std::make_pair(pos_inter, neg_inter);
+    }
+
+    std::pair<NT,NT> line_intersect(PointType const& r,
+                                    PointType const& v,
+                                    VT&,
+                                    VT&)
+    {
+        return line_intersect(r, v);
+    }
+
+    std::pair<NT,NT> line_intersect(PointType const& r,
+                                    PointType const& v,
+                                    VT&,
+                                    VT&,
+                                    NT&)
+    {
+        return line_intersect(r, v);
+    }
+
+    void update_position_internal(NT &t){
+        for (int j = 0; j < lmi.numBlocks(); j++) {
+            precomputedValues.C[j] += t * precomputedValues.B[j];
+        }
+        precomputedValues.computed_C = true;
+    }
+
+    MT get_mat() const
+    {
+        return MT::Identity(d, d);
+    }
+
+    bool is_normalized ()
+    {
+        return true;
+    }
+
+    void normalize() {}
+
+    void resetFlags()
+    {
+        precomputedValues.resetFlags();
+    }
+
+    void set_flags(bool bool_flag)
+    {
+        precomputedValues.computed_C = bool_flag;
+    }
+
+    // return the number of facets
+    int num_of_hyperplanes() const
+    {
+        return 0;
+    }
+
+    void shift(VT e) {
+        lmi.shift(e);
+        precomputedValues.resetFlags();
+        _inner_ball.first = PointType(dimension());
+    }
+
+    /// Computes the reflected direction at a point on the boundary of the spectrahedron.
+    /// Only the block that was hit contributes to the normal. If the last ray did not hit
+    /// any block (it is unbounded), v is left unchanged.
+    /// \param[in, out] v The direction of the trajectory as it hits the boundary
+    /// \param[in] r A point on the boundary of the spectrahedron
+    void compute_reflection(PointType &v, PointType const& r) const
+    {
+        int j = precomputedValues.hit_block;
+        if (j < 0) return;
+
+        VT grad(d);
+        lmi.normalizedDeterminantGradient(j, precomputedValues.eigenvector[j], grad);
+
+        // compute reflected direction
+        // if v is original direction and s the surface normal,
+        // reflected direction = v - 2 <v,s>*s
+        NT dot = 2 * v.dot(grad);
+        v += -dot * PointType(grad);
+    }
+
+    template <typename update_parameters>
+    void compute_reflection(PointType &v, PointType const& r, update_parameters& ) const
+    {
+        compute_reflection(v, r);
+    }
+
+    /// \return The dimension of the spectrahedron
+    unsigned int dimension() const {
+        return d;
+    }
+
+    /// \return The block diagonal LMI describing this spectrahedron
+    BlockLMI<NT, MT, VT> const& getLMI() const {
+        return lmi;
+    }
+
+    int is_in(PointType const& p, NT tol=NT(0)) const
+    {
+        if (lmi.isNegativeSemidefinite(p.getCoefficients())) {
+            return -1;
+        }
+        return 0;
+    }
+};
+
+#endif //VOLESTI_BLOCK_SPECTRAHEDRON_H
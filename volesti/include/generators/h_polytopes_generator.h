@@ -13,53 +13,125 @@
 #include <Eigen/Eigen>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
 
 #include "preprocess/inscribed_ellipsoid_rounding.hpp"
+#include "generators/row_streams_generator.h"
 
 #ifndef isnan
   using std::isnan;
 #endif
 
 /// This function generates a random H-polytope of given dimension and number of hyperplanes $m$
+/// If parallel is true, the rows are generated in parallel, each one from its own random
+/// stream seeded by seed and the row index; the result does not depend on the number of
+/// threads but it differs from the serial one
 /// @tparam Polytope Type of returned polytope
 /// @tparam RNGType RNGType Type
 template <class Polytope, class RNGType>
-Polytope random_hpoly(unsigned int dim, unsigned int m, int seed = std::numeric_limits<int>::signaling_NaN()) {
+Polytope random_hpoly(unsigned int dim, unsigned int m, int seed = std::numeric_limits<int>::signaling_NaN(),
+                      bool const parallel = false) {
 
     typedef typename Polytope::VT    VT;
     typedef typename Polytope::NT    NT;
     typedef typename Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>    MT;
-    typedef typename Polytope::PointType Point;
 
     int rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    RNGType rng(rng_seed);
     if (!isnan(seed)) {
-        int rng_seed = seed;
-        rng.seed(rng_seed);
+        rng_seed = seed;
     }
 
     MT A(m, dim);
     VT b(m);
-    Point p(dim);
 
-    for (int i = 0; i < m; ++i) {
+    auto fill_row = [&](int i, RNGType &rng) {
         boost::normal_distribution<> rdist(0, 1);
         NT normal = NT(0);
-        NT *data = p.pointerToData();
+        for (unsigned int j = 0; j < dim; ++j) {
+            A(i, j) = rdist(rng);
+            normal += A(i, j) * A(i, j);
+        }
+
+        normal = 1.0 / std::sqrt(normal);
+        A.row(i) *= normal;
+        b(i) = 10.0;
+    };
+
+    if (parallel) {
+        generate_rows_parallel<RNGType>(m, rng_seed, fill_row);
+    } else {
+        RNGType rng(rng_seed);
+        for (int i = 0; i < m; ++i) {
+            fill_row(i, rng);
+        }
+    }
+
+    return Polytope(dim, A, b);
+}
 
-        //RNGType rng2 = var.rng;
-        for (unsigned int i = 0; i < dim; ++i) {
-            *data = rdist(rng);
-            normal += *data * *data;
-            data++;
+/// This function generates a random sparse H-polytope of given dimension and number of
+/// hyperplanes $m$, where each of the m rows has nnz_per_row nonzero entries at uniformly
+/// random columns. The rows are unit vectors with b = 10 as in random_hpoly. Since sparse rows
+/// do not bound the polytope in general, the 2*dim facets of the cube |x_j| <= 10*sqrt(dim)
+/// are appended. The rows are generated in parallel as in random_hpoly.
+/// @tparam Polytope Type of returned polytope, with a sparse row major matrix
+/// @tparam RNGType RNGType Type
+template <class Polytope, class RNGType>
+Polytope random_sparse_hpoly(unsigned int dim, unsigned int m, unsigned int nnz_per_row,
+                             int seed = std::numeric_limits<int>::signaling_NaN()) {
+
+    typedef typename Polytope::VT    VT;
+    typedef typename Polytope::NT    NT;
+    typedef typename Polytope::MT    MT;
+    typedef Eigen::Triplet<NT>       Triplet;
+
+    int rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
+    if (!isnan(seed)) {
+        rng_seed = seed;
+    }
+    unsigned int nnz = std::max(1u, std::min(nnz_per_row, dim));
+
+    std::vector<Triplet> triplets(std::size_t(m) * nnz + 2 * dim);
+    VT b(m + 2 * dim);
+
+    generate_rows_parallel<RNGType>(m, rng_seed, [&](int i, RNGType &rng) {
+        boost::normal_distribution<> rdist(0, 1);
+        Triplet *row = triplets.data() + std::size_t(i) * nnz;
+
+        // Floyd's algorithm for nnz distinct columns
+        NT normal = NT(0), value;
+        unsigned int k = 0;
+        for (unsigned int j = dim - nnz; j < dim; ++j) {
+            boost::random::uniform_int_distribution<unsigned int> uidist(0, j);
+            unsigned int col = uidist(rng);
+            for (unsigned int l = 0; l < k; ++l) {
+                if (row[l].col() == int(col)) {
+                    col = j;
+                    break;
+                }
+            }
+            value = rdist(rng);
+            normal += value * value;
+            row[k++] = Triplet(i, col, value);
         }
 
         normal = 1.0 / std::sqrt(normal);
-        p *= normal;
-        A.row(i) = p.getCoefficients();
+        for (unsigned int l = 0; l < nnz; ++l) {
+            row[l] = Triplet(i, row[l].col(), row[l].value() * normal);
+        }
         b(i) = 10.0;
+    });
+
+    NT const box = 10.0 * std::sqrt(NT(dim));
+    for (unsigned int j = 0; j < dim; ++j) {
+        triplets[std::size_t(m) * nnz + 2 * j] = Triplet(m + 2 * j, j, NT(1));
+        triplets[std::size_t(m) * nnz + 2 * j + 1] = Triplet(m + 2 * j + 1, j, NT(-1));
+        b(m + 2 * j) = box;
+        b(m + 2 * j + 1) = box;
     }
 
+    MT A(m + 2 * dim, dim);
+    A.setFromTriplets(triplets.begin(), triplets.end());
     return Polytope(dim, A, b);
 }
 
@@ -98,12 +170,14 @@ MT get_skinny_transformation(const int d, NT const eig_ratio, int const seed)
 }
 
 /// This function generates a skinny random H-polytope of given dimension and number of hyperplanes $m$
+/// If parallel is true, the rows are generated in parallel as in random_hpoly
 /// @tparam Polytope Type of returned polytope
 /// @tparam NT Number type
 /// @tparam RNGType RNGType Type
 template <class Polytope, typename NT, class RNGType>
 Polytope skinny_random_hpoly(unsigned int dim, unsigned int m, const bool pre_rounding = false,
-                             const NT eig_ratio = NT(1000.0), int seed = std::numeric_limits<int>::signaling_NaN()) {
+                             const NT eig_ratio = NT(1000.0), int seed = std::numeric_limits<int>::signaling_NaN(),
+                             bool const parallel = false) {
 
     typedef typename Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>    MT;
     typedef typename Polytope::VT    VT;
@@ -116,7 +190,7 @@ Polytope skinny_random_hpoly(unsigned int dim, unsigned int m, const bool pre_ro
         rng.seed(rng_seed);
     }
 
-    Polytope P = random_hpoly<Polytope, RNGType>(dim, m, seed);
+    Polytope P = random_hpoly<Polytope, RNGType>(dim, m, seed, parallel);
 
     // rounding the polytope before applying the skinny transformation
     if (pre_rounding) {
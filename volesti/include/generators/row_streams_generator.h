@@ -0,0 +1,38 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef ROW_STREAMS_GEN_H
+#define ROW_STREAMS_GEN_H
+
+#include <cstdint>
+
+/// Returns the seed of the random stream of the row-th row of a generated
+/// matrix, obtained by mixing seed and row with splitmix64
+inline unsigned int row_stream_seed(unsigned int seed, unsigned int row)
+{
+    std::uint64_t z = (std::uint64_t(seed) << 32) + row + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    return static_cast<unsigned int>(z);
+}
+
+/// Calls fill_row(i, rng) for every row i < rows in parallel, where rng is a
+/// generator of type RNGType seeded with row_stream_seed(seed, i). The result
+/// is the same for any number of threads.
+/// @tparam RNGType RNGType type
+template <class RNGType, typename RowFunctor>
+void generate_rows_parallel(int rows, unsigned int seed, RowFunctor const& fill_row)
+{
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; ++i) {
+        RNGType rng(row_stream_seed(seed, i));
+        fill_row(i, rng);
+    }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #define V_POLYTOPES_GEN_H
 
 #include <exception>
+#include "generators/row_streams_generator.h"
 
 #ifndef isnan
   using std::isnan;
@@ -27,52 +28,46 @@ void removeRow(MT &matrix, unsigned int rowToRemove)
 }
 
 /// Generates a random V-polytope
+/// If parallel is true, the vertices are generated in parallel, each one from its own random
+/// stream seeded by seed and the vertex index; the result does not depend on the number of
+/// threads but it differs from the serial one
 /// @tparam Polytope polytope type
 /// @tparam RNGType RNGType type
 template <class Polytope, class RNGType>
-Polytope random_vpoly(unsigned int dim, unsigned int k, double seed = std::numeric_limits<double>::signaling_NaN()) {
+Polytope random_vpoly(unsigned int dim, unsigned int k, double seed = std::numeric_limits<double>::signaling_NaN(),
+                      bool const parallel = false) {
 
     typedef typename Polytope::MT    MT;
     typedef typename Polytope::VT    VT;
     typedef typename Polytope::NT    NT;
-    typedef typename Polytope::PointType PointType;
-    typedef PointType Point;
 
     unsigned rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    RNGType rng(rng_seed);
     if (!isnan(seed)) {
-        unsigned rng_seed = seed;
-        rng.seed(rng_seed);
+        rng_seed = seed;
     }
-    boost::normal_distribution<> rdist(0,1);
 
-    typename std::vector<NT>::iterator pit;
     MT V(k, dim);
-    unsigned int j;
-
-
-    std::vector<NT> Xs(dim,0);
-    NT normal = NT(0);
 
-    for (unsigned int i = 0; i < k; ++i) {
-
-        normal = NT(0);
-        for (unsigned int i=0; i<dim; i++) {
-            Xs[i] = rdist(rng);
-            normal += Xs[i] * Xs[i];
+    auto fill_row = [&](int i, RNGType &rng) {
+        boost::normal_distribution<> rdist(0,1);
+        NT normal = NT(0);
+        for (unsigned int j=0; j<dim; j++) {
+            V(i,j) = rdist(rng);
+            normal += V(i,j) * V(i,j);
         }
         normal = 1.0 / std::sqrt(normal);
-
-        for (unsigned int i=0; i<dim; i++) {
-            Xs[i] = Xs[i] * normal;
-        }
-
-        for (unsigned int j=0; j<dim; j++) {
-            V(i,j) = Xs[j];
+        V.row(i) *= normal;
+    };
+
+    if (parallel) {
+        generate_rows_parallel<RNGType>(k, rng_seed, fill_row);
+    } else {
+        RNGType rng(rng_seed);
+        for (unsigned int i = 0; i < k; ++i) {
+            fill_row(i, rng);
         }
     }
 
-
     VT b = VT::Ones(k);
     return Polytope(dim, V, b);
 }
@@ -9,37 +9,38 @@
 #define Z_POLYTOPES_GEN_H
 
 #include <exception>
+#include "generators/row_streams_generator.h"
 
 #ifndef isnan
   using std::isnan;
 #endif
 
 /// Generates a random Zonotope with generators draw from Gaussian distribution
+/// If parallel is true, the generators are drawn in parallel as in random_hpoly
 /// @tparam Polytope polytope type
 /// @tparam RNGType RNGType type
 template <class Polytope, class RNGType>
-Polytope gen_zonotope_gaussian(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN()) {
+Polytope gen_zonotope_gaussian(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN(),
+                               bool const parallel = false) {
 
     typedef typename Polytope::MT    MT;
     typedef typename Polytope::VT    VT;
     typedef typename Polytope::NT    NT;
 
     unsigned rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    RNGType rng(rng_seed);
     if (!isnan(seed)) {
-        unsigned rng_seed = seed;
-        rng.seed(rng_seed);
+        rng_seed = seed;
     }
-    boost::normal_distribution<> rdist(0, 1);
-    boost::normal_distribution<> rdist2(50, 33.3);
 
     MT A;
     VT b;
     A.resize(m, dim);
     b.resize(m);
-    NT rand_gaus;
 
-    for (unsigned int i = 0; i < m; ++i) {
+    auto fill_row = [&](int i, RNGType &rng) {
+        boost::normal_distribution<> rdist(0, 1);
+        boost::normal_distribution<> rdist2(50, 33.3);
+        NT rand_gaus;
         b(i) = 1.0;
         for (unsigned int j = 0; j < dim; ++j) {
             A(i,j) = rdist(rng);
@@ -52,6 +53,15 @@ Polytope gen_zonotope_gaussian(int dim, int m, double seed = std::numeric_limits
                 break;
             }
         }
+    };
+
+    if (parallel) {
+        generate_rows_parallel<RNGType>(m, rng_seed, fill_row);
+    } else {
+        RNGType rng(rng_seed);
+        for (int i = 0; i < m; ++i) {
+            fill_row(i, rng);
+        }
     }
 
     Polytope P(dim, A, b);
@@ -60,36 +70,45 @@ Polytope gen_zonotope_gaussian(int dim, int m, double seed = std::numeric_limits
 
 
 /// Generates a random Zonotope with generators draw from uniform distribution
+/// If parallel is true, the generators are drawn in parallel as in random_hpoly
 /// @tparam Polytope polytope type
 /// @tparam RNGType RNGType type
 template <class Polytope, class RNGType>
-Polytope gen_zonotope_uniform(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN()) {
+Polytope gen_zonotope_uniform(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN(),
+                              bool const parallel = false) {
 
     typedef typename Polytope::MT    MT;
     typedef typename Polytope::VT    VT;
     typedef typename Polytope::NT    NT;
 
     unsigned rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    RNGType rng(rng_seed);
     if (!isnan(seed)) {
-        unsigned rng_seed = seed;
-        rng.seed(rng_seed);
+        rng_seed = seed;
     }
-    boost::normal_distribution<> rdist(0, 1);
-    boost::random::uniform_real_distribution<> urdist1(0, 100);
 
     MT A;
     VT b;
     A.resize(m, dim);
     b.resize(m);
 
-    for (unsigned int i = 0; i < m; ++i) {
+    auto fill_row = [&](int i, RNGType &rng) {
+        boost::normal_distribution<> rdist(0, 1);
+        boost::random::uniform_real_distribution<> urdist1(0, 100);
         b(i) = 1.0;
         for (unsigned int j = 0; j < dim; ++j) {
             A(i,j) = rdist(rng);
         }
         A.row(i)=A.row(i)/A.row(i).norm();
         A.row(i) = A.row(i) * urdist1(rng);
+    };
+
+    if (parallel) {
+        generate_rows_parallel<RNGType>(m, rng_seed, fill_row);
+    } else {
+        RNGType rng(rng_seed);
+        for (int i = 0; i < m; ++i) {
+            fill_row(i, rng);
+        }
     }
 
     Polytope P(dim, A, b);
@@ -99,31 +118,31 @@ Polytope gen_zonotope_uniform(int dim, int m, double seed = std::numeric_limits<
 
 
 /// Generates a random Zonotope with generators draw from exponential distribution
+/// If parallel is true, the generators are drawn in parallel as in random_hpoly
 /// @tparam Polytope polytope type
 /// @tparam RNGType RNGType type
 template <class Polytope, class RNGType>
-Polytope gen_zonotope_exponential(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN()) {
+Polytope gen_zonotope_exponential(int dim, int m, double seed = std::numeric_limits<double>::signaling_NaN(),
+                                  bool const parallel = false) {
 
     typedef typename Polytope::MT    MT;
     typedef typename Polytope::VT    VT;
     typedef typename Polytope::NT    NT;
 
     unsigned rng_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    RNGType rng(rng_seed);
     if (!isnan(seed)) {
-        unsigned rng_seed = seed;
-        rng.seed(rng_seed);
+        rng_seed = seed;
     }
-    boost::normal_distribution<> rdist(0, 1);
-    boost::normal_distribution<> expdist(1.0/30.0);
 
     MT A;
     VT b;
     A.resize(m, dim);
     b.resize(m);
-    NT rand_exp;
 
-    for (unsigned int i = 0; i < m; ++i) {
+    auto fill_row = [&](int i, RNGType &rng) {
+        boost::normal_distribution<> rdist(0, 1);
+        boost::normal_distribution<> expdist(1.0/30.0);
+        NT rand_exp;
         b(i) = 1.0;
         for (unsigned int j = 0; j < dim; ++j) {
             A(i,j) = rdist(rng);
@@ -136,6 +155,15 @@ Polytope gen_zonotope_exponential(int dim, int m, double seed = std::numeric_lim
                 break;
             }
         }
+    };
+
+    if (parallel) {
+        generate_rows_parallel<RNGType>(m, rng_seed, fill_row);
+    } else {
+        RNGType rng(rng_seed);
+        for (int i = 0; i < m; ++i) {
+            fill_row(i, rng);
+        }
     }
 
     Polytope P(dim, A, b);
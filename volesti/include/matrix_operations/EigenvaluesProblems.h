@@ -19,6 +19,7 @@
 /// ARPACK++ standard eigenvalues solver
 //#define ARPACK_EIGENVALUES_SOLVER
 
+#include <limits>
 #include <Spectra/include/Spectra/SymEigsSolver.h>
 #include "DenseProductMatrix.h"
 #include "EigenDenseMatrix.h"
@@ -351,6 +352,82 @@ public:
         return lambdaMinPositive;
     }
 
+    /// Same as minPosLinearEigenvalue, but the Lanczos iteration starts from the vector eigvec
+    /// (e.g. the eigenvector of the previous reflection along a billiard trajectory) and uses a
+    /// small Krylov subspace with few restarts. If it does not converge, we fall back to the
+    /// cold-started solver, reusing the same Cholesky decomposition of -A, and if that fails too
+    /// (or the matrices are too small for Lanczos) to the dense generalized eigensolver.
+    /// \param[in] A Input matrix
+    /// \param[in] B Input matrix
+    /// \param[in, out] eigvec The starting vector; on output the computed eigenvector
+    /// \param[out] warm_converged True if the warm-started iteration converged
+    /// \return The minimum positive eigenvalue
+    NT minPosLinearEigenvalue_warmStart(MT const & A, MT const & B, VT &eigvec, bool &warm_converged) const {
+        int matrixDim = A.rows();
+        int const nev = 1;
+
+        warm_converged = false;
+        // Spectra needs nev < ncv <= matrixDim; we keep ncv >= nev + 2
+        if (matrixDim < nev + 2) {
+            return minPosLinearEigenvalue_dense(A, B, eigvec);
+        }
+
+        Spectra::DenseSymMatProd<NT> op(B);
+        Spectra::DenseCholesky<NT> Bop(-A);
+
+        if (eigvec.size() == matrixDim && !eigvec.isZero()) {
+            // Spectra iterates on L^{-1} B L^{-T}, where -A = LL^T, so the starting vector
+            // in these coordinates is L^T x = L^{-1} (-A x)
+            VT Ax = -A * eigvec;
+            VT init_resid(matrixDim);
+            Bop.lower_triangular_solve(Ax.data(), init_resid.data());
+
+            int ncv = std::max(nev + 2, std::min(6, matrixDim));
+            Spectra::SymGEigsSolver<NT, Spectra::LARGEST_ALGE,  Spectra::DenseSymMatProd<NT>, Spectra::DenseCholesky<NT>, Spectra::GEIGS_CHOLESKY>
+                geigs(&op, &Bop, nev, ncv);
+
+            geigs.init(init_resid.data());
+            geigs.compute(20);
+
+            if (geigs.info() == Spectra::SUCCESSFUL) {
+                VT evalues = geigs.eigenvalues();
+                eigvec = geigs.eigenvectors().col(0);
+                warm_converged = true;
+                return NT(1) / evalues(0);
+            }
+        }
+
+        int ncv = std::max(nev + 2, std::min(std::max(10, matrixDim/20), matrixDim));
+        Spectra::SymGEigsSolver<NT, Spectra::LARGEST_ALGE,  Spectra::DenseSymMatProd<NT>, Spectra::DenseCholesky<NT>, Spectra::GEIGS_CHOLESKY>
+            geigs(&op, &Bop, nev, ncv);
+
+        geigs.init();
+        geigs.compute();
+
+        if (geigs.info() != Spectra::SUCCESSFUL) {
+            return minPosLinearEigenvalue_dense(A, B, eigvec);
+        }
+        VT evalues = geigs.eigenvalues();
+        eigvec = geigs.eigenvectors().col(0);
+        return NT(1) / evalues(0);
+    }
+
+    /// Dense fallback of minPosLinearEigenvalue_warmStart: the largest eigenvalue of B x = l (-A) x.
+    /// Returns the maximum value of NT if no eigenvalue is positive, i.e. the line does not hit the boundary
+    NT minPosLinearEigenvalue_dense(MT const & A, MT const & B, VT &eigvec) const {
+        Eigen::GeneralizedSelfAdjointEigenSolver<MT> ges(B, -A);
+        if (ges.info() != Eigen::Success || ges.eigenvalues().size() == 0) {
+            return std::numeric_limits<NT>::max();
+        }
+        int last = ges.eigenvalues().size() - 1;
+        NT lambda = ges.eigenvalues()(last);
+        if (!(lambda > NT(0))) {
+            return std::numeric_limits<NT>::max();
+        }
+        eigvec = ges.eigenvectors().col(last);
+        return NT(1) / lambda;
+    }
+
     /// Transform the quadratic eigenvalue problem \[At^2 + Bt + c\] to
     /// the generalized eigenvalue problem X+lY.
     /// If the updateOnly flag is false, compute matrices X,Y from scratch;
@@ -439,6 +516,14 @@ public:
         return false;
     }
 
+    // Using the Cholesky decomposition of the lower triangular part to check membership.
+    // The factorization stops at the first non positive pivot, so it is faster than LDLT
+    // for large matrices, especially for points outside the spectrahedron
+    bool isPositiveDefinite(MT const &A) const {
+        Eigen::LLT<MT, Eigen::Lower> A_llt(A);
+        return A_llt.info() == Eigen::Success;
+    }
+
     /// Check if a matrix is indeed a correlation matrix
     /// return true if input matrix is found to be a correlation matrix
     /// |param[in] matrix
@@ -464,9 +549,10 @@ public:
     /// \return The minimum positive eigenvalue and the corresponding eigenvector
     NT minPosLinearEigenvalue_EigenSymSolver(MT const & A, MT const & B, VT &eigvec) const {
 
+        NT lambdaMinPositive;
+
 #if defined(SPECTRA_EIGENVALUES_SOLVER)
 	int matrixDim = A.rows();
-        NT lambdaMinPositive;
 
         Spectra::DenseSymMatProd<NT> op(B);
         Spectra::DenseCholesky<NT> Bop(A);
@@ -481,21 +567,18 @@ public:
     	int nconv = geigs.compute();
 
     	//retrieve results
-    	VT evalues;
-
     	if(geigs.info() == Spectra::SUCCESSFUL){
-   	    evalues = geigs.eigenvalues();
+   	    lambdaMinPositive = NT(1)/geigs.eigenvalues()(0);
    	    eigvec = geigs.eigenvectors().col(0);
+   	    return lambdaMinPositive;
     	}
 
-    	lambdaMinPositive = NT(1)/evalues(0);
-
-#elif
-        NT lambdaMinPositive = NT(0);
-        Eigen::GeneralizedSelfAdjointEigenSolver<MT> ges(B,A);
-        lambdaMinPositive = 1/ges.eigenvalues().reverse()[0];
-        eigvec = ges.eigenvectors().reverse().col(0).reverse();
+        // Lanczos did not converge, fall back to the dense solver
 #endif
+        Eigen::GeneralizedSelfAdjointEigenSolver<MT> ges(B,A);
+        int m = A.rows();
+        lambdaMinPositive = NT(1)/ges.eigenvalues()(m - 1);
+        eigvec = ges.eigenvectors().col(m - 1);
         return lambdaMinPositive;
     }
 };
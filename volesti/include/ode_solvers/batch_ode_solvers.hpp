@@ -0,0 +1,420 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2018-2020 Apostolos Chalkis
+// Copyright (c) 2020-2020 Marios Papachristou
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+/*
+  Batched solvers integrate B trajectories of the same field with different
+  initial conditions. Every sub-state x_i is stored as a dim x B matrix whose
+  columns are the trajectories.
+
+  If the oracle provides the block overload
+
+      MT operator() (unsigned int const& i, std::vector<MT> const& Xs, NT const& t) const
+
+  the field is evaluated on whole blocks, otherwise it is evaluated column by
+  column through the usual Point overload. Boundary reflections are computed
+  only for the columns that leave K_i during a step.
+
+  When compiled with OpenMP the column-wise work (field fallback, reflections,
+  independent solvers) runs in parallel across B; the oracle and the polytopes
+  then have to be safe to call concurrently (e.g. the facet index of HPolytope
+  must not be enabled).
+*/
+
+#ifndef ODE_SOLVERS_BATCH_ODE_SOLVERS_HPP
+#define ODE_SOLVERS_BATCH_ODE_SOLVERS_HPP
+
+template <typename Point, typename MT>
+struct BatchOracle {
+
+  typedef typename Point::FT NT;
+  typedef typename Point::Coeff VT;
+  typedef std::vector<Point> pts;
+  typedef std::vector<MT> MTs;
+
+  // Block evaluation
+  template <typename func>
+  static auto apply(func &F, unsigned int const& i, MTs const& Xs, NT const& t, MT &Y, int)
+    -> decltype(Y = F(i, Xs, t), void())
+  {
+    Y = F(i, Xs, t);
+  }
+
+  // Column by column evaluation
+  template <typename func>
+  static void apply(func &F, unsigned int const& i, MTs const& Xs, NT const& t, MT &Y, long)
+  {
+    int num_trajectories = Xs[0].cols();
+    Y.resize(Xs[0].rows(), num_trajectories);
+
+    #pragma omp parallel for
+    for (int j = 0; j < num_trajectories; j++) {
+      pts xs(Xs.size());
+      for (unsigned int k = 0; k < Xs.size(); k++) {
+        xs[k] = Point(VT(Xs[k].col(j)));
+      }
+      Y.col(j) = F(i, xs, t).getCoefficients();
+    }
+  }
+
+  template <typename func>
+  static void apply(func &F, unsigned int const& i, MTs const& Xs, NT const& t, MT &Y)
+  {
+    apply(F, i, Xs, t, Y, 0);
+  }
+
+  // Indices of the columns of X that are not in K
+  template <typename Polytope>
+  static std::vector<int> outside_columns(Polytope const& K, MT const& X)
+  {
+    MT AX = K.get_mat() * X;
+    AX.colwise() -= K.get_vec();
+    std::vector<int> outside;
+    for (int j = 0; j < AX.cols(); j++) {
+      if (AX.col(j).maxCoeff() > NT(0)) outside.push_back(j);
+    }
+    return outside;
+  }
+};
+
+
+template <
+typename Point,
+typename NT,
+typename Polytope,
+typename func
+>
+struct BatchLeapfrogODESolver {
+
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  typedef std::vector<MT> MTs;
+  typedef std::vector<Polytope*> bounds;
+  typedef typename Polytope::VT VT;
+  typedef BatchOracle<Point, MT> oracle;
+
+  unsigned int dim;
+  unsigned int num_trajectories;
+
+  NT eta;
+  NT t;
+  NT dl = 0.995;
+
+  func F;
+  bounds Ks;
+
+  // Contains the sub-states, one column per trajectory
+  MTs xs;
+  MTs xs_prev;
+
+  MT grad_x;
+
+  unsigned long long num_reflections = 0;
+  unsigned long long num_steps = 0;
+
+  BatchLeapfrogODESolver(NT initial_time, NT step, MTs initial_state, func oracle_, bounds boundaries) :
+  eta(step), t(initial_time), F(oracle_), Ks(boundaries), xs(initial_state) {
+    dim = xs[0].rows();
+    num_trajectories = xs[0].cols();
+    grad_x = MT::Zero(dim, num_trajectories);
+  };
+
+  void step(int k, bool accepted) {
+    num_steps++;
+    xs_prev = xs;
+    t += eta;
+
+    for (unsigned int i = 1; i < xs.size(); i += 2) {
+      unsigned int x_index = i - 1;
+      unsigned int v_index = i;
+
+      // v' <- v + eta / 2 F(x)
+      if (k == 0 && !accepted) {
+        oracle::apply(F, v_index, xs_prev, t, grad_x);
+      }
+      xs[v_index] += (eta / 2) * grad_x;
+
+      // x <- x + eta v'
+      xs[x_index] = xs_prev[x_index] + eta * xs[v_index];
+
+      if (Ks[x_index] != NULL) {
+        // A segment between two points of K stays in K, so only the columns
+        // that end up outside have to follow the reflections
+        std::vector<int> outside = oracle::outside_columns(*Ks[x_index], xs[x_index]);
+        unsigned long long reflections = 0;
+
+        #pragma omp parallel for reduction(+:reflections)
+        for (int c = 0; c < int(outside.size()); c++) {
+          int j = outside[c];
+          Point x(VT(xs_prev[x_index].col(j)));
+          Point v(VT(xs[v_index].col(j)));
+          VT Ar, Av;
+          NT T = eta;
+
+          while (true) {
+            std::pair<NT, int> pbpair = Ks[x_index]->line_positive_intersect(x, v, Ar, Av);
+            if (T <= pbpair.first) {
+              x += T * v;
+              break;
+            }
+            NT lambda = dl * pbpair.first;
+            x += lambda * v;
+            T -= lambda;
+            Ks[x_index]->compute_reflection(v, x, pbpair.second);
+            reflections++;
+          }
+
+          xs[x_index].col(j) = x.getCoefficients();
+          xs[v_index].col(j) = v.getCoefficients();
+        }
+        num_reflections += reflections;
+      }
+
+      // tilde v <- v + eta / 2 F(tilde x)
+      oracle::apply(F, v_index, xs, t, grad_x);
+      xs[v_index] += (eta / 2) * grad_x;
+    }
+  }
+
+  void steps(int num_steps, bool accepted) {
+    for (int i = 0; i < num_steps; i++) step(i, accepted);
+  }
+
+  MT const& get_state(int index) const {
+    return xs[index];
+  }
+
+  void set_state(int index, MT const& p) {
+    xs[index] = p;
+  }
+
+  NT get_eta() {
+    return eta;
+  }
+
+  void set_eta(NT &eta_) {
+    eta = eta_;
+  }
+
+  bounds get_bounds() {
+    return Ks;
+  }
+};
+
+
+template <
+typename Point,
+typename NT,
+typename Polytope,
+typename func
+>
+struct BatchRKODESolver {
+
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  typedef std::vector<MT> MTs;
+  typedef std::vector<Polytope*> bounds;
+  typedef std::vector<NT> coeffs;
+  typedef std::vector<coeffs> scoeffs;
+  typedef typename Polytope::VT VT;
+  typedef BatchOracle<Point, MT> oracle;
+
+  unsigned int dim;
+  unsigned int num_trajectories;
+
+  NT eta;
+  NT t, t_prev;
+
+  func F;
+  bounds Ks;
+
+  // Contains the sub-states, one column per trajectory
+  MTs xs;
+
+  // Stage arguments and stage derivatives
+  MTs args;
+  std::vector<MTs> ks;
+  MT y;
+
+  // Previous state boundary points and facets, per trajectory
+  MT x_prev_bound;
+  std::vector<int> prev_facet;
+
+  scoeffs as;
+  coeffs cs, bs;
+
+  // If no coefficients are given the RK4 method is assumed
+  BatchRKODESolver(NT initial_time, NT step, MTs initial_state, func oracle_, bounds boundaries) :
+  BatchRKODESolver(initial_time, step, initial_state, oracle_, boundaries,
+                   scoeffs{coeffs{}, coeffs{0.5}, coeffs{0, 0.5}, coeffs{0, 0, 1.0}},
+                   coeffs{1.0/6, 1.0/3, 1.0/3, 1.0/6}, coeffs{0, 0.5, 0.5, 1}) {};
+
+  BatchRKODESolver(NT initial_time, NT step, MTs initial_state, func oracle_, bounds boundaries,
+                   scoeffs a_coeffs, coeffs b_coeffs, coeffs c_coeffs) :
+  eta(step), t(initial_time), F(oracle_), Ks(boundaries), xs(initial_state),
+  as(a_coeffs), cs(c_coeffs), bs(b_coeffs) {
+    dim = xs[0].rows();
+    num_trajectories = xs[0].cols();
+    ks = std::vector<MTs>(order(), MTs(xs.size()));
+    prev_facet = std::vector<int>(num_trajectories, -1);
+    x_prev_bound.resize(dim, num_trajectories);
+  };
+
+  unsigned int order() const {
+    return bs.size();
+  }
+
+  void step(int k, bool accepted) {
+    t_prev = t;
+    MTs x0 = xs;
+
+    for (unsigned int ord = 0; ord < order(); ord++) {
+      t = t_prev + cs[ord] * eta;
+
+      // Stage argument x0 + eta sum_j a_ord_j k_j
+      args = x0;
+      for (unsigned int j = 0; j < ord; j++) {
+        if (as[ord][j] == NT(0)) continue;
+        for (unsigned int r = 0; r < xs.size(); r++) {
+          args[r] += (eta * as[ord][j]) * ks[j][r];
+        }
+      }
+
+      // All the derivatives of a stage are evaluated on the same argument
+      for (unsigned int i = 0; i < xs.size(); i++) {
+        oracle::apply(F, i, args, t, ks[ord][i]);
+      }
+
+      for (unsigned int i = 0; i < xs.size(); i++) {
+        y = (eta * bs[ord]) * ks[ord][i];
+
+        if (Ks[i] == NULL) {
+          xs[i] += y;
+          if (i > 0 && Ks[i-1] != NULL) reflect_derivatives(i);
+        } else {
+          update_bounded(i);
+        }
+      }
+    }
+  }
+
+  void steps(int num_steps, bool accepted) {
+    for (int i = 0; i < num_steps; i++) step(i, accepted);
+  }
+
+  MT const& get_state(int index) const {
+    return xs[index];
+  }
+
+  void set_state(int index, MT const& p) {
+    xs[index] = p;
+  }
+
+private:
+
+  // xs[i] += y with reflections on the boundary of K_i for the columns that leave it
+  void update_bounded(unsigned int i) {
+    MT x_new = xs[i] + y;
+    std::vector<int> outside = oracle::outside_columns(*Ks[i], x_new);
+
+    std::fill(prev_facet.begin(), prev_facet.end(), -1);
+    xs[i] = x_new;
+
+    #pragma omp parallel for
+    for (int c = 0; c < int(outside.size()); c++) {
+      int j = outside[c];
+      Point x(VT(x_new.col(j) - y.col(j)));
+      Point z(VT(y.col(j)));
+      VT Ar, Av;
+
+      // Find intersection (assuming a line trajectory) between x and z
+      do {
+        std::pair<NT, int> pbpair = Ks[i]->line_positive_intersect(x, z, Ar, Av);
+        if (pbpair.first >= 0 && pbpair.first <= 1) {
+          // Advance to point on the boundary and reflect the ray
+          x += (pbpair.first * 0.99) * z;
+          prev_facet[j] = pbpair.second;
+          x_prev_bound.col(j) = x.getCoefficients();
+          Ks[i]->compute_reflection(z, x, pbpair.second);
+          x += z;
+        } else {
+          prev_facet[j] = -1;
+          x += z;
+        }
+      } while (!Ks[i]->is_in(x));
+
+      xs[i].col(j) = x.getCoefficients();
+    }
+  }
+
+  // Reflect the derivative sub-state of the trajectories that hit the boundary of K_{i-1}
+  void reflect_derivatives(unsigned int i) {
+    for (int j = 0; j < int(num_trajectories); j++) {
+      if (prev_facet[j] == -1) continue;
+      Point v(VT(xs[i].col(j)));
+      Point p(VT(x_prev_bound.col(j)));
+      Ks[i-1]->compute_reflection(v, p, prev_facet[j]);
+      xs[i].col(j) = v.getCoefficients();
+      prev_facet[j] = -1;
+    }
+  }
+};
+
+
+// Runs B independent copies of a solver over the same field, e.g. for the
+// implicit solvers that have no batched counterpart. The states are
+// gathered in dim x B matrices.
+template <typename Solver>
+struct BatchODESolver {
+
+  typedef std::vector<Solver> solvers;
+
+  solvers ss;
+
+  BatchODESolver(solvers const& solvers_) : ss(solvers_) {};
+
+  unsigned int num_trajectories() const {
+    return ss.size();
+  }
+
+  void steps(int num_steps, bool accepted) {
+    #pragma omp parallel for
+    for (int j = 0; j < int(ss.size()); j++) {
+      ss[j].steps(num_steps, accepted);
+    }
+  }
+
+  template <typename MT>
+  void get_state(int index, MT &X) {
+    for (int j = 0; j < int(ss.size()); j++) {
+      auto x = ss[j].get_state(index);
+      if (j == 0) X.resize(coefficients(x).rows(), ss.size());
+      X.col(j) = coefficients(x);
+    }
+  }
+
+  template <typename MT>
+  void set_state(int index, MT const& X) {
+    for (int j = 0; j < int(ss.size()); j++) {
+      auto x = ss[j].get_state(index);
+      x = typename std::decay<decltype(coefficients(x))>::type(X.col(j));
+      ss[j].set_state(index, x);
+    }
+  }
+
+private:
+
+  template <typename P>
+  static auto coefficients(P const& p) -> decltype(p.getCoefficients()) {
+    return p.getCoefficients();
+  }
+
+  template <typename Derived>
+  static Derived const& coefficients(Eigen::MatrixBase<Derived> const& p) {
+    return p.derived();
+  }
+};
+
+#endif
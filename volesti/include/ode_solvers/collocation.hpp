@@ -50,7 +50,7 @@ struct CollocationODESolver {
   const bool exact = false;
 
   // If set to true it enables precomputation (does not recompute A and b at every step)
-  const bool precompute = true;
+  bool precompute = true;
 
   bool precompute_flag = false;
 
@@ -75,11 +75,22 @@ struct CollocationODESolver {
   // Temporal coefficients
   coeffs cs;
 
-  // Matrices for collocation methods
-  MTs As, Bs;
+  // Matrices for collocation methods (used when the field is assumed linear)
+  MTs As;
 
-  // Keeps the solution to Ax = b temporarily
-  MTs temps;
+  // Right-hand sides of all sub-states side by side, (order - 1) x (dim * xs.size()),
+  // and the corresponding solutions in decreasing order of bases
+  MT B, temp;
+
+  // Factorizations of the collocation matrices. Unless the field is assumed linear,
+  // the matrix only depends on the basis, the order and eta and a single
+  // factorization is shared by all sub-states
+  std::vector<Eigen::ColPivHouseholderQR<MT>> qrs;
+  NT factorized_eta = NT(-1);
+
+  // Weights of the basis functions at the end of the step
+  VT phi_end;
+  VT x_end;
 
   VT Ar, Av;
 
@@ -102,24 +113,62 @@ struct CollocationODESolver {
 
   void initialize_matrices() {
     As = MTs(xs.size());
-    Bs = MTs(xs.size());
-    temps = MTs(xs.size());
+    qrs = std::vector<Eigen::ColPivHouseholderQR<MT>>(xs.size());
     as = ptsv(xs.size(), pts(order(), Point(xs[0].dimension())));
     for (unsigned int i = 0; i < xs.size(); i++) {
       // Gradient matrix is of size (order - 1) x (order - 1)
       As[i].resize(order()-1, order()-1);
-      // Constants matrix is of size (order - 1) x dim
-      Bs[i].resize(order()-1, xs[0].dimension());
-      temps[i].resize(order()-1, xs[0].dimension());
     }
+    // Constants matrix is of size (order - 1) x dim for each sub-state
+    B.resize(order()-1, xs[0].dimension() * xs.size());
+    temp.resize(order()-1, xs[0].dimension() * xs.size());
+    phi_end.resize(order()-1);
+    x_end.resize(xs[0].dimension());
 
     zs = pts{Point(1)};
   }
 
+  void factorize() {
+    // The gradients of the basis functions at the collocation points only
+    // depend on cs and eta since t_ord - t_prev = cs[ord] * eta
+    for (unsigned int ord = 1; ord < order(); ord++) {
+      for (unsigned int j = 0; j < order() - 1; j++) {
+        As[0](ord-1, j) = grad_phi(t_prev + cs[ord] * eta, t_prev, order() - j - 1, order());
+      }
+    }
+    qrs[0].compute(As[0]);
+    factorized_eta = eta;
+  }
+
+  void solve() {
+    if (exact) {
+      for (unsigned int i = 0; i < xs.size(); i++) {
+        temp.middleCols(i * dim, dim) = qrs[i].solve(B.middleCols(i * dim, dim));
+      }
+    } else {
+      // All sub-states share the matrix: one solve with multiple right-hand sides
+      temp = qrs[0].solve(B);
+    }
+  }
+
+  // Sets xs[i] to the value of the collocation polynomial of the i-th sub-state at t_prev + eta
+  void evaluate_end(unsigned int i) {
+    x_end.noalias() = temp.middleCols(i * dim, dim).transpose() * phi_end;
+    x_end += phi(t_prev + eta, t_prev, 0, order()) * xs_prev[i].getCoefficients();
+    xs[i] = x_end;
+  }
+
   void step() {
     t_prev = t;
     xs_prev = xs;
 
+    if (!exact && (!precompute || factorized_eta != eta)) factorize();
+
+    // temp(j, .) holds the coefficient of the basis function of degree order - j - 1
+    for (unsigned int j = 0; j < order() - 1; j++) {
+      phi_end(j) = phi(t_prev + eta, t_prev, order() - j - 1, order());
+    }
+
     for (unsigned int ord = 0; ord < order(); ord++) {
       // Calculate t_ord
       t = t_prev + cs[ord] * eta;
@@ -132,9 +181,7 @@ struct CollocationODESolver {
           as[i][0] = xs_prev[i];
 
           if (exact) {
-            for (unsigned int j = 0; j < order() - 1; j++) {
-              Bs[i].row(j) = y.getCoefficients();
-            }
+            B.middleCols(i * dim, dim).rowwise() = y.getCoefficients().transpose();
           }
 
         }
@@ -149,26 +196,20 @@ struct CollocationODESolver {
                 temp_func = F(i,zs, t)[0];
                 As[i](ord-1, j) = temp_grad - temp_func;
               }
+              if (ord == order() - 1) qrs[i].compute(As[i]);
             }
           }
           else {
 
             // Compute new derivative (inter-point)
             dt = (cs[ord] - cs[ord-1]) * eta;
-            y = dt * y;
+            y *= dt;
 
             // Do not take into account reflections
             xs[i] += y;
 
             // Keep grads for matrix B
-            Bs[i].row(ord-1) = y.getCoefficients().transpose();
-
-            // Construct matrix A that contains the gradients of the basis functions
-            if (!precompute || (precompute && !precompute_flag)) {
-              for (unsigned int j = 0; j < order() - 1; j++) {
-                As[i](ord-1, j) = grad_phi(t, t_prev, order() - j - 1, order());
-              }
-            }
+            B.block(ord-1, i * dim, 1, dim) = y.getCoefficients().transpose();
           }
         }
 
@@ -176,65 +217,37 @@ struct CollocationODESolver {
     }
 
     // Solve linear systems
-    for (int i = 0; i < xs.size(); i++) {
-      // temp contains solution in decreasing order of bases
-      temps[i] = As[i].colPivHouseholderQr().solve(Bs[i]);
-
-      for (int j = 0; j < order() - 1; j++) {
-        // TODO Add vectorized implementation
-        // as[i][order() - j - 1] += temp(j);
-        for (int k = 0; k < xs[0].dimension(); k++) {
-          as[i][order() - j - 1].set_coord(k, temps[i](j, k));
-        }
-      }
-    }
+    solve();
 
     if (!exact) {
       for (int r = 0; r < (int) (eta / tol); r++) {
         for (unsigned int i = 0; i < xs.size(); i++) {
-          xs[i] = Point(xs[i].dimension());
-          for (unsigned int ord = 0; ord < order(); ord++) {
-            xs[i] += as[i][ord] * phi(t_prev + eta, t_prev, ord, order());
-          }
+          evaluate_end(i);
         }
 
         for (unsigned int i = 0; i < xs.size(); i++) {
           for (int ord = 1; ord < order(); ord++) {
             t_temp = cs[ord] * eta;
             y = F(i,xs, t_temp);
-            Bs[i].row(ord-1) = y.getCoefficients().transpose();
+            B.block(ord-1, i * dim, 1, dim) = y.getCoefficients().transpose();
           }
         }
 
-
         // Solve linear systems
-        for (int i = 0; i < xs.size(); i++) {
-          // temp contains solution in decreasing order of bases
-          temps[i] = As[i].colPivHouseholderQr().solve(Bs[i]);
-
-          for (int j = 0; j < order() - 1; j++) {
-            // TODO Add vectorized implementation
-            // as[i][order() - j - 1] += temp(j);
-            for (int k = 0; k < xs[0].dimension(); k++) {
-              as[i][order() - j - 1].set_coord(k, temps[i](j, k));
-            }
-          }
-        }
-
+        solve();
       }
-
-
     }
 
+    // Basis coefficients of the trajectory
+    for (unsigned int i = 0; i < xs.size(); i++) {
+      for (unsigned int j = 0; j < order() - 1; j++) {
+        as[i][order() - j - 1] = temp.block(j, i * dim, 1, dim).transpose();
+      }
+    }
 
     // Compute next point
     for (unsigned int i = 0; i < xs.size(); i++) {
       if (Ks[i] == NULL) {
-        // xs[i] = Point(xs[i].dimension());
-        // for (unsigned int ord = 0; ord < order(); ord++) {
-        //   xs[i] += as[i][ord] * phi(t_prev + eta, t_prev, ord, order());
-        // }
-
         if (prev_facet != -1 && i > 0) Ks[i-1]->compute_reflection(xs[i], prev_point, prev_facet);
         prev_facet = -1;
 
@@ -246,10 +259,7 @@ struct CollocationODESolver {
         // Point is inside polytope
         if (std::get<2>(result) == -1 && Ks[i]->is_in(std::get<1>(result))) {
           // std::cout << "Inside" << std::endl;
-          xs[i] = Point(xs[i].dimension());
-          for (unsigned int ord = 0; ord < order(); ord++) {
-            xs[i] += as[i][ord] * phi(t_prev + eta, t_prev, ord, order());
-          }
+          evaluate_end(i);
 
           prev_facet = -1;
 
@@ -286,6 +296,12 @@ struct CollocationODESolver {
     for (int i = 0; i < num_steps; i++) step();
   }
 
+  // Same interface as the other solvers; the step does not depend on whether
+  // the previous proposal was accepted
+  void steps(int num_steps, bool accepted) {
+    steps(num_steps);
+  }
+
   Point get_state(int index) {
     return xs[index];
   }
@@ -276,6 +276,12 @@ struct IntegralCollocationODESolver {
     for (int i = 0; i < num_steps; i++) step();
   }
 
+  // Same interface as the other solvers; the step does not depend on whether
+  // the previous proposal was accepted
+  void steps(int num_steps, bool accepted) {
+    steps(num_steps);
+  }
+
   Point get_state(int index) {
     return xs[index];
   }
@@ -58,6 +58,9 @@ struct LeapfrogODESolver {
 
   Point grad_x;
 
+  // Velocity of the current linear piece of the trajectory
+  Point y;
+
   MT _AA;
 
   std::pair<NT, int> pbpair;
@@ -67,11 +70,20 @@ struct LeapfrogODESolver {
 
   bool adaptive = true;
 
+  // Gradients at the last few trajectory end points, so that a trajectory that starts
+  // from a point seen before (e.g. after a rejection or at an end of a NUTS tree)
+  // does not evaluate the gradient again
+  static const unsigned int grad_cache_size = 4;
+  std::vector<std::pair<Point, Point>> grad_cache;
+  unsigned int grad_cache_next = 0;
+  unsigned long long num_gradient_evaluations = 0;
+
   LeapfrogODESolver(NT initial_time, NT step, pts initial_state, func oracle, bounds boundaries, bool adaptive_=true) :
   eta(step), eta0(step), t(initial_time), F(oracle), Ks(boundaries), xs(initial_state), adaptive(adaptive_) {
     dim = xs[0].dimension();
     _update_parameters = update_parameters();
     grad_x.set_dimension(dim);
+    y.set_dimension(dim);
     initialize();
   };
 
@@ -107,15 +119,16 @@ struct LeapfrogODESolver {
     xs_prev = xs;
     unsigned int x_index, v_index, it;
     t += eta;
-    Point y;
     for (unsigned int i = 1; i < xs.size(); i += 2) {
       
       x_index = i - 1;
       v_index = i;
 
       // v' <- v + eta / 2 F(x)
-      if (k == 0 && !accepted) {
+      if (k == 0 && !accepted && !get_cached_gradient(xs_prev[x_index], grad_x)) {
         grad_x = F(v_index, xs_prev, t);
+        num_gradient_evaluations++;
+        cache_gradient(xs_prev[x_index], grad_x);
       }
       xs[v_index] += (eta / 2) * grad_x;
 
@@ -134,6 +147,8 @@ struct LeapfrogODESolver {
           lambda_prev[x_index] = 0.0;
           Ks[x_index]->resetFlags();
         }
+        // the velocity changed since the last oracle call, so no facet can be skipped
+        _update_parameters.facet_prev = -1;
 
         pbpair =  Ks[x_index]->line_positive_intersect(xs_prev[x_index], y, Ar[x_index], Av[x_index],
                                                        lambda_prev[x_index], _update_parameters);
@@ -176,11 +191,38 @@ struct LeapfrogODESolver {
 
       // tilde v <- v + eta / 2 F(tilde x)
       grad_x = F(v_index, xs, t);
+      num_gradient_evaluations++;
       xs[v_index] += (eta / 2) * grad_x;
     }
 
   }
 
+  bool get_cached_gradient(Point const& x, Point &grad) const {
+    if (xs.size() != 2) return false;
+    for (auto const& entry : grad_cache) {
+      if (entry.first.getCoefficients() == x.getCoefficients()) {
+        grad = entry.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void cache_gradient(Point const& x, Point const& grad) {
+    if (xs.size() != 2) return;
+    if (grad_cache.size() < grad_cache_size) {
+      grad_cache.push_back(std::make_pair(x, grad));
+    } else {
+      grad_cache[grad_cache_next] = std::make_pair(x, grad);
+      grad_cache_next = (grad_cache_next + 1) % grad_cache_size;
+    }
+  }
+
+  void clear_gradient_cache() {
+    grad_cache.clear();
+    grad_cache_next = 0;
+  }
+
   void print_state() {
     for (int j = 0; j < xs.size(); j ++) {
       for (unsigned int i = 0; i < xs[j].dimension(); i++) {
@@ -192,13 +234,14 @@ struct LeapfrogODESolver {
 
   void steps(int num_steps, bool accepted) {
     for (int i = 0; i < num_steps; i++) step(i, accepted);
+    if (num_steps > 0) cache_gradient(xs[0], grad_x);
   }
 
-  Point get_state(int index) {
+  Point const& get_state(int index) const {
     return xs[index];
   }
 
-  void set_state(int index, Point p) {
+  void set_state(int index, Point const& p) {
     xs[index] = p;
   }
 
@@ -51,6 +51,7 @@
 #include "ode_solvers/oracle_functors.hpp"
 #include "ode_solvers/randomized_midpoint.hpp"
 #include "ode_solvers/generalized_leapfrog.hpp"
+#include "ode_solvers/batch_ode_solvers.hpp"
 
 #ifndef DISABLE_NLP_ORACLES
 #include "ode_solvers/collocation.hpp"
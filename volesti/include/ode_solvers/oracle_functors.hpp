@@ -147,6 +147,24 @@ struct IsotropicQuadraticFunctor {
       Point y = (-params.alpha) * x;
       return y;
     }
+
+    // Negative gradients of the columns of X, used by batched walks
+    Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>
+    operator()(Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> const& X) const {
+      return (-params.alpha) * X;
+    }
+
+    // Field on blocks of trajectories, used by batched solvers
+    Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>
+    operator()(unsigned int const& i,
+               std::vector<Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>> const& Xs,
+               NT const& t) const {
+      if (i == params.order - 1) {
+        return (-params.alpha) * Xs[0];
+      } else {
+        return Xs[i + 1];
+      }
+    }
   };
 
 
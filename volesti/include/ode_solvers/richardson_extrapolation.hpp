@@ -41,7 +41,19 @@ struct RichardsonExtrapolationODESolver {
   Point num, y;
   VT Ar, Av;
 
-  RKODESolver<Point, NT, Polytope, func> *solver;
+  // One RK4 solver per row of the tableau, so that rows can be computed concurrently
+  std::vector<RKODESolver<Point, NT, Polytope, func>> solvers;
+
+  // Number of rows computed together at the beginning of a step. It follows the
+  // number of rows the previous step needed to converge
+  unsigned int num_rows = 2;
+
+  // If enabled a step whose tableau does not converge is rejected and retried with
+  // half the step size (down to eta_min), and the step size is grown back up to eta0
+  // after a step that converged before the last row
+  bool adaptive = false;
+  NT eta0, eta_min;
+  unsigned int num_rejected = 0;
 
   func F;
   bounds Ks;
@@ -61,41 +73,52 @@ struct RichardsonExtrapolationODESolver {
 
   RichardsonExtrapolationODESolver(NT initial_time, NT step, pts initial_state,
     func oracle, bounds boundaries) :
-    eta(step), t(initial_time), F(oracle), Ks(boundaries), xs(initial_state) {
+    eta(step), t(initial_time), eta0(step), F(oracle), Ks(boundaries), xs(initial_state) {
       dim = xs[0].dimension();
+      eta_min = eta0 / NT(1 << 16);
       A = ptsm(MAX_TRIES+1, ptsv(MAX_TRIES+1, pts(xs.size())));
       initialize_solver();
     };
 
   void initialize_solver() {
-    solver = new RKODESolver<Point, NT, Polytope, func>(t, eta, xs, F, bounds{NULL});
+    solvers = std::vector<RKODESolver<Point, NT, Polytope, func>>(MAX_TRIES,
+      RKODESolver<Point, NT, Polytope, func>(t, eta, xs, F, bounds{NULL}));
   }
 
-  void step(int k, bool accepted) {
-    xs_prev = xs;
-    eta_temp = eta;
-    flag = true;
+  void disable_adaptive() {
+    adaptive = false;
+  }
 
-    // Use RK4 solver
-    solver->xs = xs_prev;
-    solver->t = t;
-    solver->eta = eta_temp;
-    solver->steps(1, false);
-    A[1][1] = solver->xs;
+  void enable_adaptive() {
+    adaptive = true;
+  }
 
+  // Row j of the tableau integrates over eta with 2^j RK4 steps of size eta / 2^j.
+  // Rows are independent; the most expensive ones are scheduled first
+  void compute_rows(unsigned int from, unsigned int to) {
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int j = int(to) - 1; j >= int(from); j--) {
+      solvers[j].xs = xs_prev;
+      solvers[j].t = t;
+      solvers[j].eta = eta / NT(1 << j);
+      solvers[j].steps(1 << j, false);
+      A[j+1][1] = solvers[j].xs;
+    }
+  }
 
-    for (unsigned int j = 1; j <= MAX_TRIES-1; j++) {
-      // Reduce step size by two
-      eta_temp /= 2;
+  // Computes the tableau from xs_prev over the current step size until two successive
+  // extrapolations agree up to tol or all rows are used. Returns the last row index
+  unsigned int extrapolate() {
+    unsigned int computed = std::min(std::max(num_rows, 2u), MAX_TRIES);
+    compute_rows(0, computed);
 
-      // Find solution with half stepsize and twice the num of steps
-      solver->xs = xs_prev;
-      solver->t = t;
-      solver->eta = eta_temp;
-      solver->steps(2*j, false);
-      A[j+1][1] = solver->xs;
+    for (unsigned int j = 1; j <= MAX_TRIES-1; j++) {
+      if (j >= computed) {
+        compute_rows(computed, j + 1);
+        computed = j + 1;
+      }
 
-      // Perform Richardson extrapolation
+      // Perform Richardson extrapolation (in a fixed order, independently of the threads)
       for (unsigned int k = 1; k <= j; k++) {
         den = 1.0 * ((4 << k) - 1);
         for (unsigned int i = 0; i < xs.size(); i++) {
@@ -112,53 +135,76 @@ struct RichardsonExtrapolationODESolver {
         if (sqrt(y.dot(y)) > error) error = sqrt(y.dot(y));
       }
 
-      if (error < tol || j == MAX_TRIES - 1) {
-        for (unsigned int i = 0; i < xs.size(); i++) {
-          y = A[j+1][j+1][i] - xs[i];
+      if (error < tol || j == MAX_TRIES - 1) return j;
+    }
+    return MAX_TRIES - 1;
+  }
 
-          if (Ks[i] == NULL) {
-            xs[i] = xs_prev[i] + y;
-            if (prev_facet != -1 && i > 0) {
-				Ks[i-1]->compute_reflection(xs[i], x_prev_bound, prev_facet);
-			}
-            prev_facet = -1;
-          }
-          else {
+  void step(int k, bool accepted) {
+    xs_prev = xs;
+    flag = true;
 
-            // Find intersection (assuming a line trajectory) between x and y
-            do {
-              // Find line intersection between xs[i] (new position) and y
-              std::pair<NT, int> pbpair = Ks[i]->line_positive_intersect(xs_prev[i], y, Ar, Av);
-              // If point is outside it would yield a negative param
-              if (pbpair.first >= 0 && pbpair.first <= 1) {
+    unsigned int j = extrapolate();
+
+    // Reject the step while the tableau does not converge: xs and t are kept
+    while (adaptive && error >= tol && eta > eta_min) {
+      num_rejected++;
+      eta = std::max(eta_min, eta / 2);
+      num_rows = MAX_TRIES;
+      j = extrapolate();
+    }
+
+    for (unsigned int i = 0; i < xs.size(); i++) {
+      y = A[j+1][j+1][i] - xs[i];
+
+      if (Ks[i] == NULL) {
+        xs[i] = xs_prev[i] + y;
+        if (prev_facet != -1 && i > 0) {
+          Ks[i-1]->compute_reflection(xs[i], x_prev_bound, prev_facet);
+        }
+        prev_facet = -1;
+      }
+      else {
 
-                xs_prev[i] += (pbpair.first * 0.95) * y;
+        // Find intersection (assuming a line trajectory) between x and y
+        do {
+          // Find line intersection between xs[i] (new position) and y
+          std::pair<NT, int> pbpair = Ks[i]->line_positive_intersect(xs_prev[i], y, Ar, Av);
+          // If point is outside it would yield a negative param
+          if (pbpair.first >= 0 && pbpair.first <= 1) {
 
-                // Update facet for reflection of derivative
-                prev_facet = pbpair.second;
-                x_prev_bound = xs_prev[i];
+            xs_prev[i] += (pbpair.first * 0.95) * y;
 
-                // Reflect ray y on the boundary point y now is the reflected ray
-                Ks[i]->compute_reflection(y, xs_prev[i], pbpair.second);
-                // Add it to the existing (boundary) point and repeat
-                xs[i] = xs_prev[i] + y;
+            // Update facet for reflection of derivative
+            prev_facet = pbpair.second;
+            x_prev_bound = xs_prev[i];
 
-              }
-              else {
-                prev_facet = -1;
-                xs[i] = xs_prev[i] + y;
-              }
-            } while (!Ks[i]->is_in(xs[i]));
+            // Reflect ray y on the boundary point y now is the reflected ray
+            Ks[i]->compute_reflection(y, xs_prev[i], pbpair.second);
+            // Add it to the existing (boundary) point and repeat
+            xs[i] = xs_prev[i] + y;
 
           }
+          else {
+            prev_facet = -1;
+            xs[i] = xs_prev[i] + y;
+          }
+        } while (!Ks[i]->is_in(xs[i]));
 
-        }
-        break;
       }
+
     }
+    num_rows = j + 1;
 
     t += eta;
 
+    // A step that converged before the last row is cheap: try a larger step size,
+    // which needs one more row
+    if (adaptive && error < tol && j < MAX_TRIES - 1 && eta < eta0) {
+      eta = std::min(eta0, 2 * eta);
+      num_rows = std::min(num_rows + 1, MAX_TRIES);
+    }
+
   }
 
   void print_state() {
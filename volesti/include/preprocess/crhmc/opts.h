@@ -38,6 +38,11 @@ public:
 
   /*PackedCS Solver Options*/
   Type solver_accuracy_threshold=1e-2;
+  // If at most this many entries of the hessian changed since the last
+  // factorization, update the cholesky factor instead of recomputing it (0 disables it).
+  // Entries are compared exactly, so this only pays off when few weights change
+  // between calls (e.g. after dynamic_weight), not after a move of every coordinate
+  unsigned int solver_update_threshold=0;
   int simdLen=1;
 
   /*Sampler options*/
@@ -11,6 +11,9 @@
 #ifndef MAX_INSCRIBED_BALL_HPP
 #define MAX_INSCRIBED_BALL_HPP
 
+#include <algorithm>
+#include <utility>
+
 #include "preprocess/rounding_util_functions.hpp"
 
 /*
@@ -59,23 +62,27 @@ void calcstep(MT const& A, MT const& A_trans, MT const& B,
     }
 }
 
-// Using MT as to deal with both dense and sparse matrices
-template <typename MT, typename VT, typename NT>
-std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b, 
-                                             unsigned int maxiter, NT tol,
-                                             const bool feasibility_only = false) 
+// The interior point iterations of max_inscribed_ball, starting from the
+// primal-dual point (x, t, s, y); B and llt have to be initialized by init_Bmat
+// and initialize_chol. The iterates are updated in place. Besides the default
+// stopping rules, the method stops when the KKT error is below err_tol, and the
+// stagnation of t is accepted only if the KKT error is below stagnation_tol.
+template <typename MT, typename VT, typename NT, typename llt_type>
+std::tuple<VT, NT, bool> max_inscribed_ball_iterations(MT const& A, VT const& b,
+                                                       MT &B, llt_type const& llt,
+                                                       VT &x, NT &t, VT &s, VT &y,
+                                                       unsigned int maxiter, NT tol,
+                                                       const bool feasibility_only,
+                                                       unsigned int &iterations,
+                                                       NT const err_tol = NT(0),
+                                                       NT const stagnation_tol = std::numeric_limits<NT>::max())
 {
-    //typedef matrix_computational_operator<MT> mat_op;
     int m = A.rows(), n = A.cols();
     bool converge = false;
 
     NT bnrm = b.norm();
     VT o_m = VT::Zero(m), o_n = VT::Zero(n), e_m = VT::Ones(m);
 
-    VT x = o_n, y = e_m / m;
-    NT t = b.minCoeff() - 1.0;
-    VT s = b - e_m * t;
-
     VT dx = o_n;
     VT dxc = dx, ds = o_m;
     VT dsc = ds, dy = o_m, mu_ds_dy(m), tmp(m), rhs(n + 1);
@@ -88,12 +95,10 @@ std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
     NT const tau0 = 0.995, power_num = 5.0 * std::pow(10.0, 15.0);
     NT *vec_iter1, *vec_iter2, *vec_iter3, *vec_iter4;
 
-    MT B, AtD(n, m), A_trans = A.transpose();
+    MT AtD(n, m), A_trans = A.transpose();
 
-    init_Bmat<NT>(B, n, A_trans, A);
-    auto llt = initialize_chol<NT>(B);
-
-    for (unsigned int i = 0; i < maxiter; ++i) {
+    unsigned int i = 0;
+    for ( ; i < maxiter; ++i) {
 
         // KKT residuals
         r1.noalias() = b - (A * x + s + t * e_m);
@@ -115,7 +120,8 @@ std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
         // progress output & check stopping
         if ( (total_err < tol && t > 0) || 
              ( t > 0 && ( (std::abs(t - t_prev) <= tol * std::min(std::abs(t), std::abs(t_prev)) ||
-                           std::abs(t - t_prev) <= tol) && i > 10) ) ||
+                           std::abs(t - t_prev) <= tol) && i > 10 && total_err < stagnation_tol) ) ||
+             (total_err < err_tol && t > 0) ||
              (feasibility_only && t > tol/2.0 && i > 0) )  
         {
             //converged
@@ -210,8 +216,145 @@ std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
         y += alphad * dy;
     }
 
+    iterations = i;
     std::tuple<VT, NT, bool> result = std::make_tuple(x, t, converge);
     return result;
 }
 
+
+// Using MT as to deal with both dense and sparse matrices
+template <typename MT, typename VT, typename NT>
+std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b, 
+                                             unsigned int maxiter, NT tol,
+                                             const bool feasibility_only = false) 
+{
+    int m = A.rows(), n = A.cols();
+    VT e_m = VT::Ones(m);
+
+    VT x = VT::Zero(n), y = e_m / m;
+    NT t = b.minCoeff() - 1.0;
+    VT s = b - e_m * t;
+
+    MT B, A_trans = A.transpose();
+    init_Bmat<NT>(B, n, A_trans, A);
+    auto llt = initialize_chol<NT>(B);
+
+    unsigned int iterations;
+    return max_inscribed_ball_iterations(A, b, B, llt, x, t, s, y, maxiter, tol,
+                                         feasibility_only, iterations);
+}
+
+/*
+    Solution of max_inscribed_ball that is used to warm start it on a related
+    polytope, e.g., when b is shifted or a few constraints change. It keeps
+    the center, the radius and the dual variables of the last call, the number
+    of interior point iterations it took, and the Cholesky factorization of
+    the Schur complement, whose symbolic analysis is reused as long as the
+    sparsity pattern of A^T A does not change.
+
+    If the number of constraints changes, the caller has to set dual to the
+    multipliers of the new constraints (e.g. zero for the new ones); otherwise
+    the dual variables are reinitialized.
+*/
+template <typename MT, typename VT, typename NT>
+struct InscribedBallWarmStart
+{
+    typedef decltype(initialize_chol<NT>(std::declval<MT const&>())) llt_ptr;
+
+    VT center;
+    NT radius = NT(0);
+    VT dual;
+    unsigned int iterations = 0;
+
+    MT B;
+    llt_ptr llt;
+};
+
+template <typename MT>
+inline static bool same_sparsity_pattern(MT const& B1, MT const& B2)
+{
+    if (B1.rows() != B2.rows() || B1.cols() != B2.cols()) return false;
+    if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)
+    {
+        if (B1.nonZeros() != B2.nonZeros()) return false;
+        return std::equal(B1.outerIndexPtr(), B1.outerIndexPtr() + B1.outerSize() + 1,
+                          B2.outerIndexPtr()) &&
+               std::equal(B1.innerIndexPtr(), B1.innerIndexPtr() + B1.nonZeros(),
+                          B2.innerIndexPtr());
+    }
+    return true;
+}
+
+/*
+    Warm started max_inscribed_ball. If warm_start holds a previous solution,
+    the iterations start from its center; the radius is set such that all the
+    slacks b - Ax - t*e are at least a small fraction of the previous radius and
+    the dual variables are raised so that s_i*y_i does not fall below a small
+    multiple of t/m, which keeps the starting point close to the central path.
+    A warm started run stops once the KKT error is below 100*tol and gets at
+    most 15 iterations; if it fails, the method restarts from the cold start.
+    On return warm_start holds the new solution and the iterations of both runs.
+*/
+template <typename MT, typename VT, typename NT>
+std::tuple<VT, NT, bool>  max_inscribed_ball(MT const& A, VT const& b,
+                                             unsigned int maxiter, NT tol,
+                                             InscribedBallWarmStart<MT, VT, NT> &warm_start)
+{
+    int m = A.rows(), n = A.cols();
+    VT e_m = VT::Ones(m);
+    VT x, y, s;
+    NT t;
+
+    bool const warm = warm_start.center.size() == n && warm_start.radius > NT(0);
+    if (warm)
+    {
+        x = warm_start.center;
+        s = b - A * x;
+        NT const min_slack = std::max(NT(0.001) * warm_start.radius, NT(10) * tol);
+        t = std::min(warm_start.radius, s.minCoeff()) - min_slack;
+        s -= e_m * t;
+
+        y = warm_start.dual.size() == m ? warm_start.dual : VT(e_m / m);
+        NT const mu = NT(0.01) * std::abs(t) / NT(m);
+        for (int i = 0; i < m; i++) {
+            y(i) = std::max(y(i), mu / s(i));
+        }
+        y /= y.sum();
+    } else
+    {
+        x = VT::Zero(n);
+        y = e_m / m;
+        t = b.minCoeff() - 1.0;
+        s = b - e_m * t;
+    }
+
+    MT B, A_trans = A.transpose();
+    init_Bmat<NT>(B, n, A_trans, A);
+    if (!warm_start.llt || !same_sparsity_pattern(B, warm_start.B))
+    {
+        warm_start.llt = initialize_chol<NT>(B);
+    }
+
+    auto result = max_inscribed_ball_iterations(A, b, B, warm_start.llt, x, t, s, y,
+                                                warm ? std::min(maxiter, 15u) : maxiter, tol, false,
+                                                warm_start.iterations, NT(100) * tol, std::sqrt(tol));
+    if (warm && !std::get<2>(result))
+    {
+        // the warm start failed, fall back to the cold start
+        unsigned int warm_iterations = warm_start.iterations;
+        x = VT::Zero(n);
+        y = e_m / m;
+        t = b.minCoeff() - 1.0;
+        s = b - e_m * t;
+        result = max_inscribed_ball_iterations(A, b, B, warm_start.llt, x, t, s, y,
+                                               maxiter, tol, false, warm_start.iterations);
+        warm_start.iterations += warm_iterations;
+    }
+    warm_start.center = x;
+    warm_start.radius = t;
+    warm_start.dual = y;
+    warm_start.B = std::move(B);
+    return result;
+}
+
 #endif // MAX_INSCRIBED_BALL_HPP
@@ -33,6 +33,13 @@
 
     Output: center of the ellipsoid y
             matrix E2^{-1} = E_transpose * E
+
+    When A is sparse and params.lumped_newton is set, no m x m (or m x n) dense
+    matrix is formed. The diagonal h^2 = diag(A E2^{-1} A^T) is obtained from the
+    sparse factorization of E2 (exactly, or with random projections when
+    params.diag_sketch_size > 0), and the dense m x m matrix G = YQ o (YQ)^T of
+    the Newton system is replaced by its row sums y o h^2 (since Q Y Q = Q), which
+    bound G from above. The reduced system for dx then is a sparse n x n system.
 */
 
 // Using MT as to deal with both dense and sparse matrices, MT_dense will be the type of result matrix
@@ -44,6 +51,8 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
     NT tol = params.tol, reg = params.reg;
 
     typedef Eigen::DiagonalMatrix<NT, Eigen::Dynamic> Diagonal_MT;
+    constexpr bool is_sparse = std::is_base_of<Eigen::SparseMatrixBase<MT>, MT>::value;
+    bool const lumped = is_sparse && params.lumped_newton;
     //typedef matrix_computational_operator<MT> mat_op;
 
     int m = A.rows(), n = A.cols();
@@ -66,9 +75,11 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
 
     VT const bmAx0 = b - A * x0, ones_m = VT::Ones(m);
 
-    MT_dense Q(m,m), YQ(m,m), G(m,m), T(m,n), ATP(n,m), ATP_A(n,n);
+    MT_dense Q, YQ, G, T, ATP, ATP_A;
     Diagonal_MT Y(m);
-    MT YA(m, n);
+    MT YA, ATP_A_sp;
+    VT G_lumped, w;
+    Eigen::SparseLU<Eigen::SparseMatrix<NT>> luATP_A;
 
     A = (ones_m.cwiseProduct(bmAx0.cwiseInverse())).asDiagonal() * A, b = ones_m;
     MT A_trans = A.transpose(), E2(n,n);
@@ -81,9 +92,18 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         Y = y.asDiagonal();
 
         update_Atrans_Diag_A<NT>(E2, A_trans, A, Y);
-        Q.noalias() = A * solve_mat(llt, E2, A_trans, logdetE2);
-        
-        h = Q.diagonal();
+        if (lumped) {
+            if constexpr (is_sparse) {
+                if (params.diag_sketch_size > 0) {
+                    sketch_diag(llt, E2, A, params.diag_sketch_size, h, logdetE2);
+                } else {
+                    solve_diag(llt, E2, A_trans, h, logdetE2);
+                }
+            }
+        } else {
+            Q.noalias() = A * solve_mat(llt, E2, A_trans, logdetE2);
+            h = Q.diagonal();
+        }
         h = h.cwiseSqrt();
 
         if (i == 1) {
@@ -100,7 +120,9 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
                 vec_iter2++;
                 vec_iter3++;
             }
-            Q *= (t * t);
+            if (!lumped) {
+                Q *= (t * t);
+            }
             Y = Y * (1.0 / (t * t));
         }
 
@@ -171,10 +193,7 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         }
 
         prev_obj = objval; // storing the objective value of the previous iteration
-        YQ.noalias() = Y * Q;
-        G = YQ.cwiseProduct(YQ.transpose());
         y2h = 2.0 * yh;
-        update_Diag_A<NT>(YA, Y, A); // YA = Y * A;
 
         vec_iter1 = y2h.data();
         vec_iter2 = z.data();
@@ -186,12 +205,7 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
             vec_iter3++;
         }
 
-        G.diagonal() += y2h_z;
         h_z = h + z;
-        Eigen::PartialPivLU<MT_dense> luG(G);
-        T.noalias() = luG.solve(MT_dense(h_z.asDiagonal()*YA));
-
-        ATP.noalias() = MT_dense(y2h.asDiagonal()*T - YA).transpose();
 
         vec_iter1 = R3.data();
         vec_iter2 = y.data();
@@ -204,13 +218,43 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         }
 
         R23 = R2 - R3Dy;
-        ATP_A.noalias() = ATP * A;
-        ATP_A.diagonal() += ones_m * reg;
-        dx = ATP_A.lu().solve(R1 + ATP * R23); // predictor step
 
-        // corrector and combined step & length
-        Adx.noalias() = A * dx;
-        dyDy = luG.solve(y2h.cwiseProduct(Adx-R23));
+        if (lumped) {
+            if constexpr (is_sparse) {
+                // G is replaced by diag(y o h^2 + y2h_z), so that
+                // ATP = A^T diag(w) with w = y o (y2h o h_z ./ G - 1)
+                G_lumped = yh.cwiseProduct(h) + y2h_z;
+                w = (y2h.cwiseProduct(h_z).cwiseQuotient(G_lumped) - ones_m).cwiseProduct(y);
+                update_Atrans_Diag_A<NT>(ATP_A_sp, A_trans, A, w.asDiagonal());
+                for (int j = 0; j < n; ++j) {
+                    ATP_A_sp.coeffRef(j, j) += reg;
+                }
+                luATP_A.compute(ATP_A_sp);
+                dx = luATP_A.solve(R1 + A_trans * w.cwiseProduct(R23)); // predictor step
+
+                // corrector and combined step & length
+                Adx.noalias() = A * dx;
+                dyDy = y2h.cwiseProduct(Adx-R23).cwiseQuotient(G_lumped);
+            }
+        } else {
+            YQ.noalias() = Y * Q;
+            G = YQ.cwiseProduct(YQ.transpose());
+            update_Diag_A<NT>(YA, Y, A); // YA = Y * A;
+
+            G.diagonal() += y2h_z;
+            Eigen::PartialPivLU<MT_dense> luG(G);
+            T.noalias() = luG.solve(MT_dense(h_z.asDiagonal()*YA));
+
+            ATP.noalias() = MT_dense(y2h.asDiagonal()*T - YA).transpose();
+
+            ATP_A.noalias() = ATP * A;
+            ATP_A.diagonal().array() += reg;
+            dx = ATP_A.lu().solve(R1 + ATP * R23); // predictor step
+
+            // corrector and combined step & length
+            Adx.noalias() = A * dx;
+            dyDy = luG.solve(y2h.cwiseProduct(Adx-R23));
+        }
 
         dy = y.cwiseProduct(dyDy);
         dz = R3Dy - z.cwiseProduct(dyDy);
@@ -254,7 +298,7 @@ std::tuple<MT_dense, VT, bool> max_inscribed_ellipsoid(MT A, VT b, VT const& x0,
         x += x0;
     }
 
-    return std::make_tuple(E2, x, converged);
+    return std::make_tuple(MT_dense(E2), x, converged);
 }
 
 
@@ -42,37 +42,41 @@ std::tuple<MT, VT, NT> min_sampling_covering_ellipsoid_rounding(Polytope &P,
     NT ratio = 10, round_val = 1.0;
     unsigned int iter = 0, j, i;
     const unsigned int num_of_samples = 10*d;//this is the number of sample points will used to compute min_ellipoid
-    PushBackWalkPolicy push_back_policy;
 
     MT T = MT::Identity(d,d);
     VT shift = VT::Zero(d);
 
     while (ratio > 6.0 && iter < 3)
     {
+        // Store points in a matrix to call Khachiyan algorithm for the minimum volume enclosing ellipsoid
+        MT Ap;
         randPoints.clear();
-        if (!P.get_points_for_rounding(randPoints))
-        {  // If P is a V-polytope then it will store its vertices in randPoints
+        if (P.get_points_for_rounding(randPoints))
+        {   // If P is a V-polytope then it will store its vertices in randPoints
+            Ap.resize(d, randPoints.size());
+            typename std::list<Point>::iterator rpit=randPoints.begin();
+
+            j = 0;
+            for ( ; rpit!=randPoints.end(); rpit++, j++) {
+                Ap.col(j) = rpit->getCoefficients();
+            }
+        }
+        else
+        {
             // If P is not a V-Polytope or number_of_vertices>20*domension
             // 2. Generate the first random point in P
             // Perform random walk on random point in the Chebychev ball
+            // and write the samples directly to the columns of Ap
             Point c = InnerBall.first;
             NT radius = InnerBall.second;
             Point p = GetPointInDsphere<Point>::apply(d, radius, rng);
             p += c;
+            Ap.resize(d, num_of_samples);
+            MatrixColumnWalkPolicy column_policy;
             RandomPointGenerator::apply(P, p, num_of_samples, walk_length,
-                                        randPoints, push_back_policy, rng);
+                                        Ap, column_policy, rng);
         }
 
-        // Store points in a matrix to call Khachiyan algorithm for the minimum volume enclosing ellipsoid
-        MT Ap(d, randPoints.size());
-        typename std::list<Point>::iterator rpit=randPoints.begin();
-
-        j = 0;
-        for ( ; rpit!=randPoints.end(); rpit++, j++) {
-            for (i=0 ; i<rpit->dimension(); i++){
-                Ap(i,j)=double((*rpit)[i]);
-            }
-        }
         MT Q(d,d); //TODO: remove dependence on ublas and copy to eigen
         VT c2(d);
         size_t w=1000;
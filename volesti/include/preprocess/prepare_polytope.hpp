@@ -0,0 +1,334 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#ifndef PREPARE_POLYTOPE_HPP
+#define PREPARE_POLYTOPE_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <vector>
+
+#include "preprocess/max_inscribed_ball.hpp"
+#include "preprocess/svd_rounding.hpp"
+#include "preprocess/min_sampling_covering_ellipsoid_rounding.hpp"
+#include "preprocess/inscribed_ellipsoid_rounding.hpp"
+#include "random_walks/compute_diameter.hpp"
+
+
+enum PreparationRounding
+{
+  NO_ROUNDING = 0,
+  SVD_ROUNDING = 1,
+  MIN_COVERING_ELLIPSOID_ROUNDING = 2,
+  MAX_INSCRIBED_ELLIPSOID_ROUNDING = 3
+};
+
+/*
+    The result of prepare_polytope: the rounding transformation (T, shift,
+    round_val) as returned by the rounding routines, the inner ball and the
+    diameter of the prepared body, and for every stage its wall time and
+    the size of the constraint matrix after the stage.
+*/
+template <typename MT, typename VT, typename Point>
+struct PreparedPolytope
+{
+    typedef typename Point::FT NT;
+
+    MT T;
+    VT shift;
+    NT round_val = NT(1);
+    std::pair<Point, NT> inner_ball;
+    NT diameter = NT(0);
+
+    std::chrono::duration<double> normalize_duration{0}, inner_ball_duration{0},
+        rounding_duration{0}, diameter_duration{0};
+    std::size_t normalize_bytes = 0, inner_ball_bytes = 0,
+        rounding_bytes = 0, diameter_bytes = 0;
+
+    template <typename StreamType>
+    void print_preparation_time(StreamType& stream) const
+    {
+        stream << "---Preparation Timing Information"<< std::endl;
+        stream << "Normalization completed in time, ";
+        stream << normalize_duration.count() << " secs, ";
+        stream << normalize_bytes << " bytes" << std::endl;
+        stream << "Inner ball completed in time, ";
+        stream << inner_ball_duration.count() << " secs, ";
+        stream << inner_ball_bytes << " bytes" << std::endl;
+        stream << "Rounding completed in time, ";
+        stream << rounding_duration.count() << " secs, ";
+        stream << rounding_bytes << " bytes" << std::endl;
+        stream << "Diameter completed in time, ";
+        stream << diameter_duration.count() << " secs, ";
+        stream << diameter_bytes << " bytes" << std::endl;
+    }
+};
+
+// memory held by the constraint matrix of P
+template <typename Polytope>
+inline static std::size_t constraint_bytes(Polytope const& P)
+{
+    typedef typename Polytope::NT NT;
+    typedef typename Polytope::MT MT;
+
+    std::size_t const vec_bytes = std::size_t(P.num_of_hyperplanes()) * sizeof(NT);
+    if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)
+    {
+        MT const& A = P.get_mat();
+        return vec_bytes + std::size_t(A.nonZeros()) * (sizeof(NT) + sizeof(typename MT::StorageIndex)) +
+               std::size_t(A.outerSize() + 1) * sizeof(typename MT::StorageIndex);
+    } else
+    {
+        return vec_bytes + std::size_t(P.num_of_hyperplanes()) * P.dimension() * sizeof(NT);
+    }
+}
+
+/*
+    After an ellipsoid rounding the origin is the center of the last
+    ellipsoid, so the inner ball of the rounded body is computed by a
+    max_inscribed_ball started from the origin instead of the cold start.
+*/
+template <typename Polytope>
+inline static void inner_ball_from_origin(Polytope &P)
+{
+    typedef typename Polytope::PointType Point;
+    typedef typename Polytope::NT NT;
+    typedef typename Polytope::MT MT;
+    typedef typename Polytope::VT VT;
+
+    P.normalize();
+    NT const tol = 1e-08;
+    InscribedBallWarmStart<MT, VT, NT> warm_start;
+    warm_start.center = VT::Zero(P.dimension());
+    warm_start.radius = P.get_vec().minCoeff();
+    if (warm_start.radius <= NT(0))
+    {
+        P.ComputeInnerBall();
+        return;
+    }
+    std::tuple<VT, NT, bool> inner_ball = max_inscribed_ball(P.get_mat(), P.get_vec(), 5000, tol, warm_start);
+    Point center(std::get<0>(inner_ball));
+    NT radius = std::get<1>(inner_ball);
+    if (!std::get<2>(inner_ball) || !P.is_in(center) || !std::isfinite(radius) || radius < tol / 2.0)
+    {
+        P.ComputeInnerBall();
+        return;
+    }
+    P.set_InnerBall(std::make_pair(center, radius));
+}
+
+/*
+    Prepares an H-polytope for sampling: normalizes the rows of A, computes
+    the inner ball, rounds P with the chosen method and computes the
+    diameter of the rounded body. The stages share their results: the inner
+    ball of the first stage starts the rounding (it replaces the feasible
+    point computation of inscribed_ellipsoid_rounding), the inner ball that
+    the sampling based roundings leave in P is reused, and the diameter is
+    taken from the final inner ball.
+*/
+template
+<
+    typename WalkTypePolicy,
+    typename MT,
+    typename VT,
+    typename Polytope,
+    typename RandomNumberGenerator
+>
+PreparedPolytope<MT, VT, typename Polytope::PointType>
+prepare_polytope(Polytope &P,
+                 RandomNumberGenerator &rng,
+                 PreparationRounding const rounding = MAX_INSCRIBED_ELLIPSOID_ROUNDING,
+                 unsigned int const walk_length = 1)
+{
+    typedef typename Polytope::PointType Point;
+    typedef typename Point::FT NT;
+    typedef std::chrono::high_resolution_clock clock;
+
+    unsigned int d = P.dimension();
+    PreparedPolytope<MT, VT, Point> prep;
+    prep.T = MT::Identity(d, d);
+    prep.shift = VT::Zero(d);
+
+    auto start = clock::now();
+    P.normalize();
+    auto end = clock::now();
+    prep.normalize_duration = end - start;
+    prep.normalize_bytes = constraint_bytes(P);
+
+    start = clock::now();
+    std::pair<Point, NT> inner_ball = P.ComputeInnerBall();
+    end = clock::now();
+    prep.inner_ball_duration = end - start;
+    prep.inner_ball_bytes = constraint_bytes(P);
+
+    start = clock::now();
+    std::tuple<MT, VT, NT> res;
+    switch (rounding)
+    {
+    case SVD_ROUNDING:
+        res = svd_rounding<WalkTypePolicy, MT, VT>(P, inner_ball, walk_length, rng);
+        break;
+    case MIN_COVERING_ELLIPSOID_ROUNDING:
+        res = min_sampling_covering_ellipsoid_rounding<WalkTypePolicy, MT, VT>(P, inner_ball,
+                                                                                walk_length, rng);
+        break;
+    case MAX_INSCRIBED_ELLIPSOID_ROUNDING:
+        res = inscribed_ellipsoid_rounding<MT, VT, NT>(P, inner_ball.first);
+        inner_ball_from_origin(P);
+        break;
+    default:
+        res = std::make_tuple(prep.T, prep.shift, NT(1));
+        break;
+    }
+    std::tie(prep.T, prep.shift, prep.round_val) = res;
+    end = clock::now();
+    prep.rounding_duration = end - start;
+    prep.rounding_bytes = constraint_bytes(P) + std::size_t(prep.T.size() + prep.shift.size()) * sizeof(NT);
+
+    start = clock::now();
+    prep.inner_ball = P.InnerBall();
+    prep.diameter = compute_diameter<Polytope>::template compute<NT>(P);
+    end = clock::now();
+    prep.diameter_duration = end - start;
+    prep.diameter_bytes = constraint_bytes(P);
+
+    return prep;
+}
+
+/*
+    Prepares a set of independent polytopes concurrently. Polytope i uses
+    its own generator seeded with seed + i, so the result does not depend
+    on the number of threads.
+*/
+template
+<
+    typename WalkTypePolicy,
+    typename MT,
+    typename VT,
+    typename RandomNumberGenerator,
+    typename Polytope
+>
+std::vector<PreparedPolytope<MT, VT, typename Polytope::PointType>>
+prepare_polytopes(std::vector<Polytope> &polytopes,
+                  unsigned int const seed,
+                  PreparationRounding const rounding = MAX_INSCRIBED_ELLIPSOID_ROUNDING,
+                  unsigned int const walk_length = 1)
+{
+    int num_polytopes = polytopes.size();
+    std::vector<PreparedPolytope<MT, VT, typename Polytope::PointType>> result(num_polytopes);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_polytopes; i++)
+    {
+        RandomNumberGenerator rng(polytopes[i].dimension());
+        rng.set_seed(seed + i);
+        result[i] = prepare_polytope<WalkTypePolicy, MT, VT>(polytopes[i], rng, rounding, walk_length);
+    }
+    return result;
+}
+
+/*
+    Writes a prepared polytope, i.e. the rounded body together with the
+    rounding transformation, its inner ball and diameter, so that it can be
+    reloaded with read_prepared_polytope instead of preparing it again.
+    The numbers are written with max_digits10 digits so they round trip,
+    together with the normalization flag of P.
+*/
+template <typename Polytope, typename MT, typename VT, typename Point>
+void write_prepared_polytope(std::ostream &os, Polytope const& P,
+                             PreparedPolytope<MT, VT, Point> const& prep)
+{
+    typedef typename Point::FT NT;
+    typedef typename Polytope::DenseMT DenseMT;
+
+    unsigned int d = P.dimension();
+    int m = P.num_of_hyperplanes();
+    DenseMT A = P.get_mat();
+    VT b = P.get_vec();
+    VT center = prep.inner_ball.first.getCoefficients();
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::setprecision(std::numeric_limits<NT>::max_digits10);
+
+    os << "prepared_polytope " << m << " " << d << " " << P.is_normalized() << "\n";
+    for (int i = 0; i < m; i++)
+    {
+        os << b(i);
+        for (unsigned int j = 0; j < d; j++)
+        {
+            os << " " << A(i, j);
+        }
+        os << "\n";
+    }
+    for (unsigned int i = 0; i < d; i++)
+    {
+        for (unsigned int j = 0; j < d; j++)
+        {
+            os << prep.T(i, j) << (j + 1 < d ? " " : "\n");
+        }
+    }
+    for (unsigned int i = 0; i < d; i++) os << prep.shift(i) << (i + 1 < d ? " " : "\n");
+    for (unsigned int i = 0; i < d; i++) os << center(i) << (i + 1 < d ? " " : "\n");
+    os << prep.inner_ball.second << " " << prep.round_val << " " << prep.diameter << "\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+// Reads a prepared polytope written by write_prepared_polytope. A and b are
+// restored as written, they are not normalized again.
+// Returns false if the stream does not hold a prepared polytope.
+template <typename Polytope, typename MT, typename VT, typename Point>
+bool read_prepared_polytope(std::istream &is, Polytope &P,
+                            PreparedPolytope<MT, VT, Point> &prep)
+{
+    typedef typename Point::FT NT;
+    typedef typename Polytope::DenseMT DenseMT;
+
+    std::string tag;
+    int m, d;
+    bool normalized;
+    if (!(is >> tag >> m >> d >> normalized) || tag != "prepared_polytope" || m <= 0 || d <= 0)
+    {
+        return false;
+    }
+
+    DenseMT A(m, d);
+    VT b(m), center(d);
+    for (int i = 0; i < m; i++)
+    {
+        is >> b(i);
+        for (int j = 0; j < d; j++) is >> A(i, j);
+    }
+    prep.T.resize(d, d);
+    prep.shift.resize(d);
+    for (int i = 0; i < d; i++)
+    {
+        for (int j = 0; j < d; j++) is >> prep.T(i, j);
+    }
+    for (int i = 0; i < d; i++) is >> prep.shift(i);
+    for (int i = 0; i < d; i++) is >> center(i);
+    NT radius;
+    is >> radius >> prep.round_val >> prep.diameter;
+    if (!is)
+    {
+        return false;
+    }
+
+    P = Polytope(d, A, b);
+    if (normalized)
+    {
+        P.set_normalized();
+    }
+    prep.inner_ball = std::make_pair(Point(center), radius);
+    P.set_InnerBall(prep.inner_ball);
+    return true;
+}
+
+#endif // PREPARE_POLYTOPE_HPP
@@ -13,6 +13,8 @@
 
 #include <memory>
 
+#include <boost/random.hpp>
+
 #include "Spectra/include/Spectra/SymEigsSolver.h"
 #include "Spectra/include/Spectra/MatOp/DenseSymMatProd.h"
 #include "Spectra/include/Spectra/MatOp/SparseSymMatProd.h"
@@ -23,6 +25,13 @@ struct JohnEllipsoidParams {
     unsigned int maxiter = 500;
     NT tol = 1e-6;
     NT reg = 1e-3;
+    // For sparse matrices only: if true, the m x m matrix of the Newton system
+    // is replaced by its row sums, so that no m x m dense matrix is formed; the
+    // Newton steps are then approximate and more iterations may be needed
+    bool lumped_newton = false;
+    // Only used with lumped_newton: if positive, the diagonal of A E^{-1} A^T is
+    // estimated with this many random projections instead of computed exactly
+    unsigned int diag_sketch_size = 0;
 };
 
 template <typename NT>
@@ -155,6 +164,77 @@ solve_mat(std::unique_ptr<Eigen_lltMT> const& llt,
     }
 }
 
+// Number of rows of A handled by one sparse solve in solve_diag
+const int solve_diag_block_size = 64;
+
+/*
+    Computes the diagonal of A H^{-1} A^T and the logdet of the Cholesky factor
+    of H for a sparse A, given A^T. The rows of A are processed in blocks, so that
+    only an n x solve_diag_block_size dense matrix is formed per block; the blocks
+    are independent and are solved in parallel.
+*/
+template <typename Eigen_lltMT, typename MT, typename VT, typename NT>
+inline static void solve_diag(std::unique_ptr<Eigen_lltMT> const& llt,
+                              MT const& H, MT const& A_trans, VT &diag, NT &logdetE)
+{
+    using DenseMT = Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>;
+    static_assert(std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value,
+                  "solve_diag expects a sparse matrix.");
+
+    llt->factorize(H);
+    logdetE = llt->matrixL().nestedExpression().diagonal().array().log().sum();
+
+    const int m = A_trans.cols();
+    const int num_blocks = (m + solve_diag_block_size - 1) / solve_diag_block_size;
+    diag.resize(m);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < num_blocks; k++)
+    {
+        const int first = k * solve_diag_block_size;
+        const int len = std::min(solve_diag_block_size, m - first);
+        DenseMT rhs = DenseMT(A_trans.middleCols(first, len));
+        DenseMT X = llt->solve(rhs);
+        diag.segment(first, len) = X.cwiseProduct(rhs).colwise().sum().transpose();
+    }
+}
+
+/*
+    Randomized estimate of the diagonal of A H^{-1} A^T for a sparse A.
+    With P H P^T = L L^T, we have a_i^T H^{-1} a_i = ||L^{-1} P a_i||^2, which is
+    approximated by ||S L^{-1} P a_i||^2 for a k x n Gaussian matrix S with
+    variance 1/k (Johnson-Lindenstrauss). It costs k sparse solves and one
+    sparse-dense product instead of m solves.
+*/
+template <typename Eigen_lltMT, typename MT, typename VT, typename NT>
+inline static void sketch_diag(std::unique_ptr<Eigen_lltMT> const& llt,
+                               MT const& H, MT const& A, unsigned int const k,
+                               VT &diag, NT &logdetE)
+{
+    using DenseMT = Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic>;
+    static_assert(std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value,
+                  "sketch_diag expects a sparse matrix.");
+
+    llt->factorize(H);
+    logdetE = llt->matrixL().nestedExpression().diagonal().array().log().sum();
+
+    const int n = H.rows();
+    boost::mt19937 rng(n + k);
+    boost::normal_distribution<NT> rdist(NT(0), NT(1) / std::sqrt(NT(k)));
+    DenseMT St(n, k);
+    for (int j = 0; j < k; j++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            St(i, j) = rdist(rng);
+        }
+    }
+    // W = P^T L^{-T} S^T, so that W W^T approximates H^{-1}
+    DenseMT W = llt->permutationPinv() * DenseMT(llt->matrixU().solve(St));
+    DenseMT AW = A * W;
+    diag = AW.rowwise().squaredNorm();
+}
+
 template <typename NT, typename MT, typename diag_MT>
 inline static void update_Atrans_Diag_A(MT &H, MT const& A_trans,
                                         MT const& A, diag_MT const& D)
@@ -393,9 +473,16 @@ void get_barrier_hessian_grad(MT const& A, MT const& A_trans, VT const& b,
                 BarrierType == EllipsoidType::VAIDYA_BARRIER)
   {
     // Computing sigma(x)_i = (a_i^T H^{-1} a_i) / (b_i - a_i^Tx)^2
-    MT_dense HA = solve_mat(llt, H, A_trans, obj_val);
-    MT_dense aiHai = HA.transpose().cwiseProduct(A);
-    sigma = (aiHai.rowwise().sum()).cwiseProduct(s_sq);
+    if constexpr (std::is_base_of<Eigen::SparseMatrixBase<MT>, MT >::value)
+    {
+      solve_diag(llt, H, A_trans, sigma, obj_val);
+      sigma = sigma.cwiseProduct(s_sq);
+    } else
+    {
+      MT_dense HA = solve_mat(llt, H, A_trans, obj_val);
+      MT_dense aiHai = HA.transpose().cwiseProduct(A);
+      sigma = (aiHai.rowwise().sum()).cwiseProduct(s_sq);
+    }
   }
 
   if constexpr (BarrierType == EllipsoidType::LOG_BARRIER)
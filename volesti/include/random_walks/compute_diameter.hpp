@@ -12,6 +12,7 @@
 #include "convex_bodies/ballintersectconvex.h"
 #include "convex_bodies/hpolytope.h"
 #include "convex_bodies/spectrahedra/spectrahedron.h"
+#include "convex_bodies/spectrahedra/block_spectrahedron.h"
 #ifndef DISABLE_LPSOLVE
     #include "convex_bodies/vpolytope.h"
     #include "convex_bodies/vpolyintersectvpoly.h"
@@ -21,6 +22,75 @@
 #include "convex_bodies/orderpolytope.h"
 #include "convex_bodies/ellipsoid.h"
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+
+/*
+    Diameter of the point set given by the rows of V. The rows are visited
+    in decreasing distance r_i from their centroid and the distances from
+    row i to the rows after it are computed in blocks through the Gram
+    matrix. Any pair of rows that are not visited yet is at distance at most
+    r_s + r_{s+1}, where s is the next row, so the search stops as soon as
+    the largest distance found reaches this bound; the result is exact.
+    If max_seconds elapse first, the method returns the upper bound
+    max(largest distance found, r_s + r_{s+1}).
+*/
+template <typename NT, typename MT>
+NT point_set_diameter(MT const& V,
+                      double const max_seconds = std::numeric_limits<double>::infinity())
+{
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> DenseMT;
+
+    int k = V.rows();
+    if (k < 2) return NT(0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    VT c = V.colwise().mean().transpose();
+    VT r = (V.rowwise() - c.transpose()).rowwise().norm();
+
+    std::vector<int> order(k);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&r](int i, int j) { return r(i) > r(j); });
+
+    DenseMT W(k, V.cols());
+    VT g(k);
+    for (int i = 0; i < k; ++i) {
+        W.row(i) = V.row(order[i]) - c.transpose();
+        g(i) = W.row(i).squaredNorm();
+    }
+
+    int const block_size = 64;
+    NT diameter_sq = NT(0);
+    for (int s = 0; s < k - 1; s += block_size)
+    {
+        NT bound = r(order[s]) + r(order[s + 1]);
+        if (diameter_sq >= bound * bound) break;
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        if (elapsed.count() > max_seconds) {
+            return std::max(std::sqrt(diameter_sq), bound);
+        }
+
+        int rows = std::min(block_size, k - 1 - s), cols = k - s - 1;
+        DenseMT G = W.middleRows(s, rows) * W.bottomRows(cols).transpose();
+        NT block_max = NT(0);
+        #pragma omp parallel for reduction(max:block_max)
+        for (int i = 0; i < rows; ++i) {
+            // row s + i of W against the rows s + i + 1, ..., k - 1
+            for (int j = i; j < cols; ++j) {
+                NT dist_sq = g(s + i) + g(s + 1 + j) - NT(2) * G(i, j);
+                if (dist_sq > block_max) block_max = dist_sq;
+            }
+        }
+        diameter_sq = std::max(diameter_sq, block_max);
+    }
+    return std::sqrt(diameter_sq);
+}
+
 
 template <typename GenericPolytope>
 struct compute_diameter
@@ -51,6 +121,17 @@ struct compute_diameter<Spectrahedron<Point>>
     }
 };
 
+template <typename Point>
+struct compute_diameter<BlockSpectrahedron<Point>>
+{
+    template <typename NT>
+    static NT compute(BlockSpectrahedron<Point> &P)
+    {
+        std::pair<Point, NT> inner_ball = P.ComputeInnerBall();
+        return NT(6) * NT(P.dimension()) * inner_ball.second;
+    }
+};
+
 template <typename Point>
 struct compute_diameter<CorrelationSpectrahedron<Point>>
 {
@@ -78,20 +159,10 @@ template <typename Point>
 struct compute_diameter<VPolytope<Point>>
 {
     template <typename NT>
-    static NT compute(VPolytope<Point> &P)
+    static NT compute(VPolytope<Point> &P,
+                      double const max_seconds = std::numeric_limits<double>::infinity())
     {
-        typedef typename VPolytope<Point>::MT MT;
-        NT diameter = NT(0), diam_iter;
-        MT V = P.get_mat();
-        for (int i = 0; i < V.rows(); ++i) {
-            for (int j = 0; j < V.rows(); ++j) {
-                if (i != j) {
-                    diam_iter = (V.row(i) - V.row(j)).norm();
-                    if (diam_iter > diameter) diameter = diam_iter;
-                }
-            }
-        }
-        return diameter;
+        return point_set_diameter<NT>(P.get_mat(), max_seconds);
     }
 };
 
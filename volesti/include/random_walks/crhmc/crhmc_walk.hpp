@@ -221,6 +221,17 @@ struct CRHMCWalk {
         module_update->updateModules(*this, rng);
       }
     }
+    // Report how often the cholesky factor was recomputed and how often it was
+    // updated because only a few weights changed
+    template <typename StreamType>
+    void print_factorization_information(StreamType &stream) {
+      auto &chol = solver->ham.solver;
+      stream << "---Factorization Information" << std::endl;
+      stream << "Full factorizations: " << chol.numExact.back() << "\n";
+      stream << "Low-rank updates: " << chol.numUpdate << "\n";
+      stream << "Failed updates (refactorized): " << chol.numUpdateFallback
+             << "\n";
+    }
 #ifdef TIME_KEEPING
     void initialize_timers() {
       H_duration = std::chrono::duration<double>::zero();
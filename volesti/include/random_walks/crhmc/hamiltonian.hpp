@@ -66,6 +66,7 @@ public:
     xs = {x, x};
     lsc = MT::Zero(simdLen, n);
     solver.accuracyThreshold = options.solver_accuracy_threshold;
+    solver.updateThreshold = options.solver_update_threshold;
     if (options.DynamicWeight)
     {
       weighted_barrier =
@@ -125,7 +126,7 @@ public:
     move(xs);
     if (!prepared) {
       MT Hinv = (hess.cwiseInverse()).transpose();
-      solver.decompose((Tx *)Hinv.data());
+      solver.updateOrDecompose((Tx *)Hinv.data());
       dUDx_empty = true;
     }
     prepared = true;
@@ -42,6 +42,9 @@ struct HamiltonianMonteCarloWalk {
     }
   };
 
+  // The walk reuses the gradient and the value of f at the current point across calls
+  // to apply (they are keyed on the point only), so F and f must describe the same
+  // density for the lifetime of the walk; call clear_cache() after changing them.
   template
   <
     typename Point,
@@ -92,6 +95,11 @@ struct HamiltonianMonteCarloWalk {
     // Density exponent
     NegativeLogprobFunctor &f;
 
+    // Value of f at x, reused as the starting energy of the next trajectory
+    Point x_f;
+    NT f_x;
+    bool has_f_x = false;
+
     Walk(Polytope *P,
       Point &p,
       NegativeGradientFunctor &neg_grad_f,
@@ -133,10 +141,16 @@ struct HamiltonianMonteCarloWalk {
 
       if (metropolis_filter) {
         // Calculate initial Hamiltonian
-        H = hamiltonian(x, v);
+        if (!has_f_x || x_f.getCoefficients() != x.getCoefficients()) {
+          x_f = x;
+          f_x = f(x);
+          has_f_x = true;
+        }
+        H = f_x + 0.5 * v.dot(v);
 
         // Calculate new Hamiltonian
-        H_tilde = hamiltonian(x_tilde, v_tilde);
+        NT f_x_tilde = f(x_tilde);
+        H_tilde = f_x_tilde + 0.5 * v_tilde.dot(v_tilde);
 
         // Log-sum-exp trick
         log_prob = H - H_tilde < 0 ? H - H_tilde : 0;
@@ -146,6 +160,8 @@ struct HamiltonianMonteCarloWalk {
         total_acceptance_log_prob += log_prob;
         if (u_logprob < log_prob) {
           x = x_tilde;
+          x_f = x_tilde;
+          f_x = f_x_tilde;
           accepted = true;
         }
         else {
@@ -173,6 +189,249 @@ struct HamiltonianMonteCarloWalk {
     void enable_adaptive() {
       solver->enable_adaptive();
     }
+
+    // Must be called if the density changes between calls to apply
+    // (e.g. after a temperature update), since gradients and values of f are reused
+    void clear_cache() {
+      solver->clear_gradient_cache();
+      has_f_x = false;
+    }
+  };
+
+
+  // B chains that take the same number of leapfrog steps in lockstep. The positions
+  // are stored as the columns of a d x B matrix, so a gradient functor that provides
+  //     MT operator()(MT const& X) const
+  // (returning the negative gradients of the columns of X) is evaluated once per step
+  // for all the chains. Otherwise the functor is called on each column. The gradient
+  // at the end of a trajectory is reused as the starting gradient of the next one,
+  // so as in Walk, clear_cache() must be called if F and f change between calls to apply.
+  template
+  <
+    typename Point,
+    typename Polytope,
+    typename RandomNumberGenerator,
+    typename NegativeGradientFunctor,
+    typename NegativeLogprobFunctor
+  >
+  struct BatchWalk {
+
+    typedef std::vector<Point> pts;
+    typedef typename Point::FT NT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+
+    struct update_parameters
+    {
+        update_parameters()
+                :   facet_prev(-1), hit_ball(false), inner_vi_ak(0.0), ball_inner_norm(0.0)
+        {}
+        int facet_prev;
+        bool hit_ball;
+        double inner_vi_ak;
+        double ball_inner_norm;
+    };
+
+    template <typename F, typename = void>
+    struct has_block_gradient : std::false_type {};
+
+    template <typename F>
+    struct has_block_gradient<F, std::void_t<decltype(std::declval<F const&>()(std::declval<MT const&>()))>>
+      : std::is_same<decltype(std::declval<F const&>()(std::declval<MT const&>())), MT> {};
+
+    parameters<NT, NegativeGradientFunctor> &params;
+    Polytope *P;
+    NegativeGradientFunctor &F;
+    NegativeLogprobFunctor &f;
+
+    unsigned int dim;
+    unsigned int num_chains;
+    NT eta;
+    NT dl = 0.995;
+    bool adaptive = true;
+
+    // Current states (columns) with the negative gradients and values of f at them
+    MT X, G;
+    VT f_X;
+
+    // Proposals
+    MT X_tilde, V_tilde, G_tilde;
+    VT f_X_tilde;
+
+    std::vector<bool> accepted;
+    std::vector<update_parameters> reflection_params;
+
+    // A of the polytope, copied once; Ar[j] = A x_j is kept up to date along the
+    // trajectory of chain j and recomputed only when its proposal was rejected
+    typename Polytope::MT A;
+    std::vector<VT> Ar, Av;
+
+    long num_runs = 0;
+    long total_discarded_samples = 0;
+    unsigned long long num_reflections = 0;
+    unsigned long long num_steps = 0;
+
+    BatchWalk(Polytope *P_,
+              MT const& X0,
+              NegativeGradientFunctor &neg_grad_f,
+              NegativeLogprobFunctor &neg_logprob_f,
+              parameters<NT, NegativeGradientFunctor> &param) :
+      params(param), P(P_), F(neg_grad_f), f(neg_logprob_f)
+    {
+      dim = X0.rows();
+      num_chains = X0.cols();
+      eta = params.eta;
+      X = X0;
+      accepted.assign(num_chains, false);
+      Ar.resize(num_chains);
+      Av.resize(num_chains);
+      reflection_params.resize(num_chains);
+
+      if (P != NULL) {
+        A = P->get_mat();
+      }
+
+      G.resize(dim, num_chains);
+      clear_cache();
+    }
+
+    // Recomputes the gradients and the values of f at the current states;
+    // must be called if the density changes between calls to apply
+    void clear_cache() {
+      evaluate_gradients(X, G);
+      f_X.resize(num_chains);
+      for (unsigned int j = 0; j < num_chains; j++) {
+        f_X(j) = f(Point(VT(X.col(j))));
+      }
+    }
+
+    inline void apply(RandomNumberGenerator &rng,
+                      int walk_length=1,
+                      bool metropolis_filter=true)
+    {
+      num_runs++;
+
+      MT V(dim, num_chains);
+      for (unsigned int j = 0; j < num_chains; j++) {
+        V.col(j) = GetDirection<Point>::apply(dim, rng, false).getCoefficients();
+      }
+
+      X_tilde = X;
+      V_tilde = V;
+      G_tilde = G;
+
+      if (P != NULL) {
+        for (unsigned int j = 0; j < num_chains; j++) {
+          if (!accepted[j]) {
+            Ar[j].noalias() = A * X.col(j);
+          }
+        }
+      }
+
+      for (int k = 0; k < walk_length; k++) {
+        // same step size adaptation as LeapfrogODESolver, with the reflections
+        // averaged over the chains
+        num_steps += num_chains;
+        eta = adaptive ? (params.eta * num_steps) / (num_steps + num_reflections) : params.eta;
+
+        V_tilde.noalias() += (eta / 2) * G_tilde;
+        for (unsigned int j = 0; j < num_chains; j++) {
+          move_chain(j, eta);
+        }
+        evaluate_gradients(X_tilde, G_tilde);
+        V_tilde.noalias() += (eta / 2) * G_tilde;
+      }
+
+      f_X_tilde.resize(num_chains);
+      for (unsigned int j = 0; j < num_chains; j++) {
+        f_X_tilde(j) = f(Point(VT(X_tilde.col(j))));
+
+        NT log_prob = NT(0);
+        if (metropolis_filter) {
+          NT H = f_X(j) + 0.5 * V.col(j).squaredNorm();
+          NT H_tilde = f_X_tilde(j) + 0.5 * V_tilde.col(j).squaredNorm();
+          log_prob = H - H_tilde < 0 ? H - H_tilde : 0;
+        }
+
+        if (!metropolis_filter || log(rng.sample_urdist()) < log_prob) {
+          X.col(j) = X_tilde.col(j);
+          G.col(j) = G_tilde.col(j);
+          f_X(j) = f_X_tilde(j);
+          accepted[j] = true;
+        } else {
+          total_discarded_samples++;
+          accepted[j] = false;
+        }
+      }
+    }
+
+    Point get_point(unsigned int j) const {
+      return Point(VT(X.col(j)));
+    }
+
+    NT get_discard_ratio() const {
+      return (1.0 * total_discarded_samples) / (num_runs * num_chains);
+    }
+
+    void disable_adaptive() {
+      adaptive = false;
+    }
+
+    void enable_adaptive() {
+      adaptive = true;
+    }
+
+  private:
+
+    void evaluate_gradients(MT const& Xs, MT &Gs) {
+      if constexpr (has_block_gradient<NegativeGradientFunctor>::value) {
+        Gs = F(Xs);
+      } else {
+        pts xs{Point(dim), Point(dim)};
+        for (unsigned int j = 0; j < num_chains; j++) {
+          xs[0] = Point(VT(Xs.col(j)));
+          Gs.col(j) = F(1, xs, NT(0)).getCoefficients();
+        }
+      }
+    }
+
+    // x <- x + eta v for chain j, reflecting at the boundary of P
+    void move_chain(unsigned int j, NT const& eta) {
+      if (P == NULL) {
+        X_tilde.col(j).noalias() += eta * V_tilde.col(j);
+        return;
+      }
+
+      Point x(VT(X_tilde.col(j)));
+      Point y(VT(V_tilde.col(j)));
+      // the velocity changed since the last reflection, so no facet can be skipped
+      update_parameters &rparams = reflection_params[j];
+      rparams.facet_prev = -1;
+
+      if (Av[j].size() != P->num_of_hyperplanes()) {
+        Av[j].setZero(P->num_of_hyperplanes());
+      }
+      NT lambda_prev = NT(0);
+      NT T = eta;
+
+      while (true) {
+        std::pair<NT, int> pbpair = P->line_positive_intersect(x, y, Ar[j], Av[j], lambda_prev, rparams);
+        if (T <= pbpair.first) {
+          x += T * y;
+          // Av[j] = A y, so this keeps Ar[j] = A x
+          Ar[j].noalias() += T * Av[j];
+          break;
+        }
+        lambda_prev = dl * pbpair.first;
+        x += lambda_prev * y;
+        T -= lambda_prev;
+        P->compute_reflection(y, x, rparams);
+        num_reflections++;
+      }
+
+      X_tilde.col(j) = x.getCoefficients();
+      V_tilde.col(j) = y.getCoefficients();
+    }
   };
 };
 
@@ -33,6 +33,7 @@ struct NutsHamiltonianMonteCarloWalk {
   struct parameters {
     NT epsilon; // tolerance in mixing
     NT eta; // step size
+    unsigned int max_tree_depth = 10; // maximum number of doublings per iteration
 
     parameters(
       OracleFunctor const& F,
@@ -75,11 +76,20 @@ struct NutsHamiltonianMonteCarloWalk {
     // Average acceptance probability
     NT average_acceptance = 0;
 
-    // References to xs
+    // Current state
     Point x, v;
 
-    // Helper points
-    Point v_pl, v_min, v_min_j, v_pl_j, X_pl, X_pl_j, X_min, X, X_rnd_j, X_min_j, x_pl_min;
+    // Preallocated state pool: the two ends of the trajectory, the first
+    // leaf of the current subtree and the candidate of the current subtree.
+    // The ends are addressed by index, so extending the tree in one
+    // direction works in place on the corresponding slot
+    static const unsigned int pool_size = 4;
+    std::vector<Point> pool_x, pool_v;
+
+    // Statistics of the last iteration and running total of gradient evaluations
+    unsigned int tree_depth = 0;
+    long num_gradient_evaluations = 0;
+    long total_gradient_evaluations = 0;
 
     // Gradient function
     NegativeGradientFunctor &F;
@@ -105,17 +115,9 @@ struct NutsHamiltonianMonteCarloWalk {
     {
       dim = p.dimension();
 
-      v_pl.set_dimension(dim);
-      v_min.set_dimension(dim);
-      v_min_j.set_dimension(dim);
-      v_pl_j.set_dimension(dim);
-      X_pl.set_dimension(dim);
-      X_pl_j.set_dimension(dim);
-      X_min.set_dimension(dim);
-      X.set_dimension(dim);
-      X_rnd_j.set_dimension(dim);
-      X_min_j.set_dimension(dim);
-      x_pl_min.set_dimension(dim);
+      v.set_dimension(dim);
+      pool_x.assign(pool_size, Point(dim));
+      pool_v.assign(pool_size, Point(dim));
 
       eps_step = params.eta;
       mu = std::log(10*eps_step);
@@ -178,16 +180,24 @@ struct NutsHamiltonianMonteCarloWalk {
       num_runs++;
 
       int x_counting_total = 0;
+      long num_steps = 0;
+      long gradients_before = solver_gradient_evaluations(*solver, 0);
+
+      // Slots of the state pool
+      unsigned int e_min = 0, e_pl = 1;
+      const unsigned int first = 2, cand = 3;
 
       // Pick a random velocity
-      v = GetDirection<Point>::apply(dim, rng, false);
-      
-      v_pl = v;
-      v_min = NT(-1) * v;
-      X_pl = x;
-      X_min = x;
-      
-      NT h1 = hamiltonian(x, v);
+      for (unsigned int i = 0; i < dim; i++)
+      {
+        pool_v[e_pl].set_coord(i, rng.sample_ndist());
+      }
+      pool_v[e_min] = pool_v[e_pl];
+      pool_v[e_min] *= NT(-1);
+      pool_x[e_pl] = x;
+      pool_x[e_min] = x;
+
+      NT h1 = hamiltonian(x, pool_v[e_pl]);
 
       NT uu = std::log(rng.sample_urdist()) - h1;
       int j = -1;
@@ -203,26 +213,20 @@ struct NutsHamiltonianMonteCarloWalk {
       while (s)
       {
         j++;
-        
+
         if (burnin)
         {
           na = std::pow(NT(2), NT(j));
         }
 
         NT dir = rng.sample_urdist();
-                
-        if (dir > 0.5)
-        {
-          v = v_pl;
-          X = X_pl;
-        }
-        else
-        {
-          v = v_min;
-          X = X_min;
-        }
-        X_rnd_j = X;
-                
+
+        // The subtree grows from the end in direction dir and is written in place
+        unsigned int cur = (dir > 0.5) ? e_pl : e_min;
+        Point &X = pool_x[cur];
+        Point &V = pool_v[cur];
+        pool_x[cand] = X;
+
         int x_counting = 0;
         int num_samples = int(std::pow(NT(2), NT(j)));
         accepted = false;
@@ -232,17 +236,18 @@ struct NutsHamiltonianMonteCarloWalk {
           if (!accepted)
           {
             solver->set_state(0, X);
-            solver->set_state(1, v);
+            solver->set_state(1, V);
           }
 
           // Get proposals
           solver->steps(walk_length, accepted);
+          num_steps += walk_length;
           accepted = true;
 
           X = solver->get_state(0);
-          v = solver->get_state(1);
+          V = solver->get_state(1);
 
-          NT hj = hamiltonian(X, v);
+          NT hj = hamiltonian(X, V);
 
           if (burnin)
           {
@@ -256,82 +261,71 @@ struct NutsHamiltonianMonteCarloWalk {
           }
 
           bool pos_state = false;
-          if (uu < -hj) 
+          if (uu < -hj)
           {
             pos_state = true;
             pos_state_single = true;
             x_counting = x_counting + 1;
             x_counting_total = x_counting_total + 1;
           }
-                 
-          if (k == 1) 
+
+          if (k == 1)
           {
-            if (dir > 0.5) 
-            {
-              X_min_j = X;
-              v_min_j = v;
-            } 
-            else 
-            {
-              X_pl_j = X;
-              v_pl_j = v;
-            }
+            pool_x[first] = X;
+            pool_v[first] = V;
           }
-          if (k == num_samples) 
+          if (k == num_samples)
           {
-            if (dir > 0.5) 
+            if (dir > 0.5)
             {
-              x_pl_min = X - X_min_j;
-              if ((x_pl_min.dot(v) < 0) || (x_pl_min.dot(v_min_j) < 0)) 
+              if (u_turn(pool_x[first], X, V, pool_v[first]))
               {
                 s = false;
               }
-            } 
-            else 
+            }
+            else
             {
-              x_pl_min = X_pl_j - X;
-              if ((x_pl_min.dot(v) < 0) || (x_pl_min.dot(v_pl_j) < 0)) 
+              if (u_turn(X, pool_x[first], V, pool_v[first]))
               {
                 s = false;
               }
             }
           }
-          if ((rng.sample_urdist() < (1/NT(x_counting))) && pos_state) 
+          if ((rng.sample_urdist() < (1/NT(x_counting))) && pos_state)
           {
-            X_rnd_j = X;
+            pool_x[cand] = X;
           }
         }
 
-        if (dir > 0.5) 
-        {
-          X_pl = X;
-          v_pl = v;
-        } 
-        else 
+        if (s && (rng.sample_urdist() < (NT(x_counting) / NT(x_counting_total))))
         {
-          X_min = X;
-          v_min = v;
-        }
-                
-        if (s && (rng.sample_urdist() < (NT(x_counting) / NT(x_counting_total)))) 
-        {
-          x = X_rnd_j;
+          x = pool_x[cand];
           if (pos_state_single)
-          { 
+          {
             updated = true;
           }
         }
-                
-        if (s) 
+
+        if (s)
         {
-          x_pl_min = X_pl - X_min;
-          if ((x_pl_min.dot(v_min) < 0) || (x_pl_min.dot(v_pl) < 0)) 
+          if (u_turn(pool_x[e_min], pool_x[e_pl], pool_v[e_min], pool_v[e_pl]))
           {
-              s = false;
+            s = false;
           }
         }
+
+        if (j + 1 >= int(params.max_tree_depth))
+        {
+          s = false;
+        }
       }
 
+      tree_depth = j + 1;
+      long gradients_after = solver_gradient_evaluations(*solver, 0);
+      num_gradient_evaluations = (gradients_before < 0) ? num_steps
+                                                        : gradients_after - gradients_before;
+      total_gradient_evaluations += num_gradient_evaluations;
+
       if (updated)
       {
         total_acceptance++;
@@ -350,6 +344,32 @@ struct NutsHamiltonianMonteCarloWalk {
       }
     }
 
+    // Checks the no-U-turn criterion between the states (x_from, .) and (x_to, .)
+    // without forming x_to - x_from
+    inline bool u_turn(Point const& x_from,
+                       Point const& x_to,
+                       Point const& v1,
+                       Point const& v2) const
+    {
+      return ((x_to.getCoefficients() - x_from.getCoefficients()).dot(v1.getCoefficients()) < 0) ||
+             ((x_to.getCoefficients() - x_from.getCoefficients()).dot(v2.getCoefficients()) < 0);
+    }
+
+    // Number of gradient evaluations done by the solver so far, or -1 when the
+    // solver does not count them (then integration steps are reported instead)
+    template <typename S>
+    static auto solver_gradient_evaluations(S const& solver_, int)
+      -> decltype(static_cast<long>(solver_.num_gradient_evaluations))
+    {
+      return static_cast<long>(solver_.num_gradient_evaluations);
+    }
+
+    template <typename S>
+    static long solver_gradient_evaluations(S const&, long)
+    {
+      return -1;
+    }
+
     inline NT hamiltonian(Point &pos, Point &vel) const {
       return f(pos) + 0.5 * vel.dot(vel);
     }
@@ -369,6 +389,7 @@ struct NutsHamiltonianMonteCarloWalk {
     void reset_num_runs() {
       num_runs = 0;
       total_acceptance = 0;
+      total_gradient_evaluations = 0;
     }
 
     NT get_ratio_acceptance() {
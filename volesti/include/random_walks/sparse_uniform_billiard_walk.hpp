@@ -14,7 +14,9 @@
 #include <Eigen/Eigen>
 #include <Eigen/Sparse>
 #include <Eigen/SparseCholesky>
+#include <algorithm>
 #include <optional>
+#include <vector>
 #include "convex_bodies/hpolytope.h"
 #include "sampling/sphere.hpp"
 #include "generators/boost_random_number_generator.hpp"
@@ -215,6 +217,15 @@ private:
         mutable std::vector<bool> computed;
         mutable std::vector<NT> b_rounded;
 
+        // A_original * L^{-1}, where H = L L^T; kept only if it is not denser than
+        // A_original and L_inv together
+        SparseRowMT A_rounded;
+        bool has_A_rounded = false;
+
+        // A_rounded is formed this many rows at a time, so that the construction stops
+        // early once the fill exceeds the bound
+        static constexpr int rounded_rows_chunk = 256;
+
         NT  inner_vi_ak = NT(0);
         int facet_prev = -1;
 
@@ -224,15 +235,56 @@ private:
             row_norms (A.rows()),
             computed (A.rows(), false),
             b_rounded (A.rows()) 
-        {}
+        {
+            // the rows of A_rounded are computed chunk by chunk and we give up as soon as
+            // their nonzeros exceed the bound, so a dense product is never materialized
+            typedef Eigen::Triplet<NT> Triplet;
+            std::size_t const max_nnz = A_original.nonZeros() + L_inv.nonZeros();
+            int const m = A_original.rows();
+            std::vector<Triplet> triplets;
+
+            for (int start = 0; start < m; start += rounded_rows_chunk) {
+                int rows = std::min(rounded_rows_chunk, m - start);
+                SparseMT chunk_t = A_original.middleRows(start, rows).transpose();
+                L_inv.template triangularView<Eigen::Upper>().solveInPlace(chunk_t);
+                chunk_t.prune(NT(0));
+                if (triplets.size() + chunk_t.nonZeros() > max_nnz) {
+                    return;
+                }
+                for (int k = 0; k < chunk_t.outerSize(); ++k) {
+                    for (typename SparseMT::InnerIterator it(chunk_t, k); it; ++it) {
+                        triplets.emplace_back(start + k, it.row(), it.value());
+                    }
+                }
+            }
+
+            A_rounded.resize(m, A_original.cols());
+            A_rounded.setFromTriplets(triplets.begin(), triplets.end());
+            has_A_rounded = true;
+        }
+
+        // y = A_original * L^{-1} * x, i.e. the product of A with a point or direction
+        // given in rounded coordinates
+        void apply_rounded_operator(VT const& x, VT& y) const {
+            if (has_A_rounded) {
+                y.noalias() = A_rounded * x;
+            } else {
+                VT x_orig = L_inv.transpose().template triangularView<Eigen::Lower>().solve(x);
+                y.noalias() = A_original * x_orig;
+            }
+        }
 
         const VT& get_normalized_A_rounded_row(int facet) const {
             if (!computed[facet]) {
-                VT A_row_dense = VT::Zero(A_original.cols());
-                for (typename SparseRowMT::InnerIterator it(A_original, facet); it; ++it) 
-                    A_row_dense[it.col()] = it.value();
+                if (has_A_rounded) {
+                    A_rounded_rows[facet] = A_rounded.row(facet).transpose();
+                } else {
+                    VT A_row_dense = VT::Zero(A_original.cols());
+                    for (typename SparseRowMT::InnerIterator it(A_original, facet); it; ++it) 
+                        A_row_dense[it.col()] = it.value();
 
-                A_rounded_rows[facet] = L_inv.template triangularView<Eigen::Upper>().solve(A_row_dense);
+                    A_rounded_rows[facet] = L_inv.template triangularView<Eigen::Upper>().solve(A_row_dense);
+                }
 
                 row_norms[facet] = A_rounded_rows[facet].norm();
                 if (row_norms[facet] > NT(1e-12))
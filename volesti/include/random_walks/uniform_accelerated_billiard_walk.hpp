@@ -28,13 +28,19 @@ struct AcceleratedBilliardWalk
             :   param(0, false)
     {}
 
+    // adapt_L: raise L to the longest chord observed during sampling
+    AcceleratedBilliardWalk(double L, bool set, bool adapt_L)
+            :   param(L, set, adapt_L)
+    {}
+
     struct parameters
     {
-        parameters(double L, bool set)
-                :   m_L(L), set_L(set)
+        parameters(double L, bool set, bool adapt = false)
+                :   m_L(L), set_L(set), adapt_L(adapt)
         {}
         double m_L;
         bool set_L;
+        bool adapt_L;
     };
 
     struct update_parameters
@@ -97,6 +103,7 @@ struct AcceleratedBilliardWalk
             _L = params.set_L ? params.m_L
                               : compute_diameter<GenericPolytope>
                                 ::template compute<NT>(P);
+            _adapt_L = params.adapt_L;
             if constexpr (SPARSE) {
                 _AA = (P.get_mat() * P.get_mat().transpose());
             } else {
@@ -134,7 +141,12 @@ struct AcceleratedBilliardWalk
 
                 it = 0;
                 std::pair<NT, int> pbpair = P.line_first_positive_intersect(_p, _v, _lambdas, _Av, _update_parameters);
-                
+                // both ends of the segment from _p to the boundary lie in P,
+                // so its length is a lower bound on the diameter
+                if (pbpair.first > _max_chord) {
+                    _max_chord = pbpair.first;
+                }
+
                 if (T <= pbpair.first) {
                     _p += (T * _v);
                     _lambda_prev = T;
@@ -177,6 +189,9 @@ struct AcceleratedBilliardWalk
                         _lambda_prev = T;
                         break;
                     }
+                    if (pbpair.first > _max_chord) {
+                        _max_chord = pbpair.first;
+                    }
                     _lambda_prev = dl * pbpair.first;
                     if constexpr (SPARSE) {
                         _update_parameters.moved_dist += _lambda_prev;
@@ -197,6 +212,9 @@ struct AcceleratedBilliardWalk
                     _p = p0;
                 }
             }
+            if (_adapt_L && _max_chord > _L) {
+                _L = _max_chord;
+            }
             p = _p;
         }
 
@@ -278,6 +296,13 @@ struct AcceleratedBilliardWalk
             return _L;
         }
 
+        // the longest segment to the boundary observed so far,
+        // a lower bound on the diameter
+        NT get_max_chord() const
+        {
+            return _max_chord;
+        }
+
     private :
 
         template
@@ -361,6 +386,8 @@ struct AcceleratedBilliardWalk
         }
 
         double _L;
+        bool _adapt_L = false;
+        NT _max_chord = NT(0);
         Point _p;
         Point _v;
         NT _lambda_prev;
@@ -292,6 +292,14 @@ private:
     Vector _stored_s_centrality;
     IPMDouble _stored_centrality_error;
 
+    //H(x)^{-1} A^T and the Cholesky factorization of A H(x)^{-1} A^T, both without the
+    //1/mu scaling, so that they only depend on x and can be reused while x does not change.
+    Vector _stored_x_normal_equations;
+    Matrix _stored_H_inv_A_top;
+    Eigen::LLT<Matrix> _stored_normal_equations_LLT;
+
+    void update_normal_equations();
+
 
     IPMDouble mu();
 
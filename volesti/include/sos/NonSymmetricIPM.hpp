@@ -62,44 +62,59 @@ Vector<IPMDouble> NonSymmetricIPM<IPMDouble>::solve(Matrix &M_, Vector const v_)
 //TODO:make sure all memory is preallocated.
 
 template<typename IPMDouble>
-std::vector<std::pair<Vector<IPMDouble>, Vector<IPMDouble> > >
-NonSymmetricIPM<IPMDouble>::solve_andersen_andersen_subsystem(
-        std::vector<std::pair<Vector, Vector> > &v) {
+void NonSymmetricIPM<IPMDouble>::update_normal_equations() {
+    if (_stored_x_normal_equations.rows() == x.rows() && _stored_x_normal_equations == x) {
+        return;
+    }
 
-    _custom_timers[8].start();
     _custom_timers[4].start();
-    //TODO: double transposition. Figure out how to multiply solve from RHS.
-//    Matrix A_H_inv = LLT.solve(A.transpose()).transpose() / mu();
-    Matrix A_H_inv = _barrier->llt_solve(x, A.transpose()).transpose() / mu();
-    A_H_inv.eval();
+    _stored_H_inv_A_top = _barrier->llt_solve(x, A.transpose());
     _custom_timers[4].stop();
     _custom_timers[5].start();
 
     //TODO: Use better method to sparsify A.
-    Matrix A_H_inv_A_top = A_H_inv * A_sparse.transpose();
-    A_H_inv_A_top.eval();
+    Matrix A_H_inv_A_top = A_sparse * _stored_H_inv_A_top;
 
     _custom_timers[5].stop();
     _custom_timers[6].start();
-    Eigen::LLT<Matrix> A_H_inv_A_top_LLT = A_H_inv_A_top.llt();
+    _stored_normal_equations_LLT.compute(A_H_inv_A_top);
     _custom_timers[6].stop();
+
+    _stored_x_normal_equations = x;
+}
+
+//Solves all right hand sides at once. The normal equations are scaled by mu, i.e.
+//(A H^{-1} A^T / mu) s = r1 - A H^{-1} r2 / mu and t = H^{-1} (r2 + A^T s) / mu.
+template<typename IPMDouble>
+std::vector<std::pair<Vector<IPMDouble>, Vector<IPMDouble> > >
+NonSymmetricIPM<IPMDouble>::solve_andersen_andersen_subsystem(
+        std::vector<std::pair<Vector, Vector> > &v) {
+
+    _custom_timers[8].start();
+    update_normal_equations();
     _custom_timers[8].stop();
     _custom_timers[9].start();
 
-    std::vector<std::pair<Vector, Vector> > results;
-    //TODO: might be possible to solve these system in batches!
+    const int m = A.rows();
+    const int n = A.cols();
+    const int k = v.size();
+
+    Matrix R1(m, k);
+    Matrix R2(n, k);
+    for (int i = 0; i < k; i++) {
+        R1.col(i) = v[i].first;
+        R2.col(i) = v[i].second;
+    }
+
     //TODO: check whether Conjugate Gradient Method solves Normal Equations more efficiently.
-    for (unsigned i = 0; i < v.size(); i++) {
-        Vector &r1 = v[i].first;
-        Vector &r2 = v[i].second;
-        Vector r2_solve = A * _barrier->llt_solve(x, r2) / mu();
-//        Vector new_s_intermediate = A_H_inv_A_top_LLT.matrixL().solve(-(r2_solve - r1));
-//        Vector new_s = A_H_inv_A_top_LLT.matrixU().solve(new_s_intermediate);
-        Vector new_s = A_H_inv_A_top_LLT.solve(-(r2_solve - r1));
-//        Vector new_t_intermediate = LLT.matrixL().solve((r2 + A.transpose() * new_s) / mu());
-//        Vector new_t = LLT.matrixU().solve(new_t_intermediate);
-        Vector new_t = _barrier->llt_solve(x, (r2 + A.transpose() * new_s) / mu());
-        results.emplace_back(std::pair<Vector, Vector>(new_s, new_t));
+    Matrix H_inv_R2 = _barrier->llt_solve(x, R2);
+    Matrix S = _stored_normal_equations_LLT.solve(mu() * R1 - A * H_inv_R2);
+    Matrix T = (H_inv_R2 + _stored_H_inv_A_top * S) / mu();
+
+    std::vector<std::pair<Vector, Vector> > results;
+    results.reserve(k);
+    for (int i = 0; i < k; i++) {
+        results.emplace_back(std::pair<Vector, Vector>(S.col(i), T.col(i)));
     }
     _custom_timers[9].stop();
     return results;
@@ -120,7 +135,6 @@ Vector<IPMDouble> NonSymmetricIPM<IPMDouble>::andersen_andersen_solve(Vector con
     Vector const r_xs = rhs.segment(m + n + 1, n);
     Vector const r_tk = rhs.segment(m + n + 1 + n, 1);
 
-    Matrix mu_H_x = mu() * _barrier->hessian(x);
     IPMDouble mu_H_tau = mu() / (tau * tau);
 
     std::vector<std::pair<Vector, Vector> > new_rhs_vectors;
@@ -151,7 +165,7 @@ Vector<IPMDouble> NonSymmetricIPM<IPMDouble>::andersen_andersen_solve(Vector con
 
     Vector d_yx = uv + d_tau * pq;
     Vector d_x = d_yx.segment(m, n);
-    Vector d_s = r_xs - mu_H_x * d_x;
+    Vector d_s = r_xs - mu() * _barrier->hessian_vector_product(x, d_x);
     IPMDouble d_kappa = r_tk.sum() - mu_H_tau * d_tau;
 
     Vector d_tau_vec(1);
@@ -254,7 +268,8 @@ int NonSymmetricIPM<IPMDouble>::run_solver() {
                               - A.transpose() * y + c * tau - s).norm() / (A.transpose() * y - c * tau + s).norm();
         IPMDouble err_opt = abs(b.dot(pred_dir.y) - c.dot(pred_dir.x) - pred_dir.kappa
                                 + b.dot(y) - c.dot(x) - kappa) / abs(-b.dot(y) + c.dot(x) + kappa);
-        IPMDouble err_cent = (pred_dir.s + mu() * _barrier->hessian(x) * pred_dir.x + s).norm() / s.norm();
+        IPMDouble err_cent = (pred_dir.s + mu() * _barrier->hessian_vector_product(x, pred_dir.x) + s).norm()
+                               / s.norm();
         IPMDouble err_cent2 = abs(pred_dir.kappa + mu() / (tau * tau) * pred_dir.tau + kappa) / kappa;
 
         IPMDouble err_sum = err_primal + err_dual + err_opt + err_cent + err_cent2;
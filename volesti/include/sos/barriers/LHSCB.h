@@ -36,6 +36,8 @@ public:
 
     virtual Matrix hessian(Vector x) = 0;
 
+    virtual Vector hessian_vector_product(Vector x, const Vector &v);
+
     virtual Eigen::LLT<Matrix> llt(Vector x, bool symmetrize = 0);
 
     virtual Matrix llt_solve(Vector x, const Matrix &rhs);
@@ -78,6 +78,11 @@ Eigen::LLT<Matrix<IPMDouble> > LHSCB<IPMDouble>::llt(Vector x, bool symmetrize)
     return _stored_LLT[0].second;
 }
 
+template <typename IPMDouble>
+Vector<IPMDouble> LHSCB<IPMDouble>::hessian_vector_product(Vector x, const Vector &v) {
+    return hessian(x) * v;
+}
+
 template <typename IPMDouble>
 Matrix<IPMDouble> LHSCB<IPMDouble>::llt_solve(Vector x, const Matrix &rhs) {
     return llt(x).solve(rhs);
@@ -68,6 +68,8 @@ public:
 
     Matrix hessian(Vector x) override;
 
+    Vector hessian_vector_product(Vector x, const Vector &v) override;
+
 //    Matrix inverse_hessian(Vector x) override;
     bool in_interior(Vector x) override;
 
@@ -58,11 +58,30 @@ Matrix<IPMDouble> ProductBarrier<IPMDouble>::hessian(Vector x) {
    return evaluate(x, &LHSCB<IPMDouble>::hessian);
 }
 
+//Multiplies with the block diagonal Hessian without assembling it.
+template<typename IPMDouble>
+Vector<IPMDouble> ProductBarrier<IPMDouble>::hessian_vector_product(Vector x, const Vector &v) {
+    update_segments();
+    Vector product_vector(this->_num_variables);
+#ifdef PARALLELIZE_BARRIERS
+#pragma omp parallel for
+#endif
+    for (unsigned i = 0; i < _barriers.size(); ++i) {
+        std::pair<int, int> &seg = _segments[i];
+        LHSCB<IPMDouble> *barrier = _barriers[i];
+        Vector x_seg = x.segment(seg.first, seg.second - seg.first);
+        Vector v_seg = v.segment(seg.first, seg.second - seg.first);
+        product_vector.segment(seg.first, seg.second - seg.first) = barrier->hessian_vector_product(x_seg, v_seg);
+    }
+    return product_vector;
+}
+
 template<typename IPMDouble>
 bool ProductBarrier<IPMDouble>::in_interior(Vector x) {
     this->_in_interior_timer.start();
     update_segments();
-    std::vector<bool> in_interior_vec(_barriers.size());
+    //std::vector<bool> is bit-packed, so concurrent writes to different entries would race.
+    std::vector<char> in_interior_vec(_barriers.size());
 #ifdef PARALLELIZE_BARRIERS
 #pragma omp parallel for
 #endif
@@ -73,7 +92,7 @@ bool ProductBarrier<IPMDouble>::in_interior(Vector x) {
         in_interior_vec[i] =  barrier->in_interior(x_seg);
     }
     this->_in_interior_timer.stop();
-    return std::all_of(in_interior_vec.begin(), in_interior_vec.end(), [](bool b){return b;});
+    return std::all_of(in_interior_vec.begin(), in_interior_vec.end(), [](char b){return b;});
 }
 
 template<typename IPMDouble>
@@ -11,8 +11,11 @@
 #define ZONOTOPE_EXACT_VOL_H
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <Eigen/Eigen>
 
 // From rosetta code at http://rosettacode.org/wiki/Combinations#C.2B.2B
 // We made some adjustments to vectorize the output
@@ -41,33 +44,222 @@ inline std::vector< std::vector<int> > comb(int N, int K)
 }
 
 
+inline std::uint64_t binomial_coefficient(int n, int k)
+{
+    if (k < 0 || k > n) return 0;
+    k = std::min(k, n - k);
+    std::uint64_t b = 1;
+    for (int i = 1; i <= k; ++i) {
+        b = b * std::uint64_t(n - k + i) / std::uint64_t(i);
+    }
+    return b;
+}
+
+
+// The t-subsets of {0,...,n-1} in revolving-door order (Knuth, TAOCP 7.2.1.3,
+// Algorithm R): two consecutive subsets differ by exactly one element. The order
+// lists the subsets without n-1 first and then the ones with n-1 in reverse order,
+// which allows to start the enumeration from any rank without generating the
+// previous subsets.
+class revolving_door_combinations
+{
+public:
+    revolving_door_combinations(int n, int t, std::uint64_t rank = 0)
+        :   _t(t)
+        ,   _c(t + 2)
+    {
+        unrank(n, t, rank);
+        _c[t + 1] = n;
+    }
+
+    // the j-th smallest element of the current subset, 0 <= j < t
+    int operator[](int j) const
+    {
+        return _c[j + 1];
+    }
+
+    // Move to the next subset, out is the element that is removed and in the one
+    // that is added. Returns false after the last subset.
+    bool next(int& out, int& in)
+    {
+        std::vector<int>& c = _c;
+
+        if (_t % 2 == 1) {
+            if (c[1] + 1 < c[2]) {
+                out = c[1];
+                in = ++c[1];
+                return true;
+            }
+        } else if (c[1] > 0) {
+            out = c[1];
+            in = --c[1];
+            return true;
+        }
+
+        bool decrease = (_t % 2 == 1);
+        for (int j = 2; j <= _t; ++j, decrease = !decrease) {
+            if (decrease) {
+                // here c[j] = c[j-1] + 1
+                if (c[j] >= j) {
+                    out = c[j];
+                    in = j - 2;
+                    c[j] = c[j-1];
+                    c[j-1] = j - 2;
+                    return true;
+                }
+            } else {
+                // here c[j-1] = j - 2
+                if (c[j] + 1 < c[j+1]) {
+                    out = c[j-1];
+                    in = c[j] + 1;
+                    c[j-1] = c[j];
+                    c[j] = c[j] + 1;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    void unrank(int n, int t, std::uint64_t rank)
+    {
+        while (t > 0) {
+            if (n == t) {
+                for (int j = 1; j <= t; ++j) _c[j] = j - 1;
+                return;
+            }
+            std::uint64_t without_last = binomial_coefficient(n - 1, t);
+            if (rank >= without_last) {
+                _c[t] = n - 1;
+                rank = binomial_coefficient(n - 1, t - 1) - 1 - (rank - without_last);
+                t--;
+            }
+            n--;
+        }
+    }
+
+    int _t;
+    std::vector<int> _c; // c[1] < ... < c[t] and the sentinel c[t+1] = n
+};
+
+
+// Sum of |det| of the n x n submatrices of the n x k matrix G whose column sets
+// have ranks [first, last) in revolving-door order. Consecutive submatrices differ
+// in one column, so the determinant and the inverse are updated in O(n^2) with the
+// matrix determinant lemma and the Sherman-Morrison formula. The submatrix is
+// factorized again every refresh_period steps to bound the accumulated error and
+// whenever it is close to singular. The sum is compensated (Neumaier).
+template <typename NT, typename MT>
+NT sum_of_abs_determinants(MT const& G,
+                           std::uint64_t const& first,
+                           std::uint64_t const& last)
+{
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    const unsigned int refresh_period = 32;
+    const NT singular_tol = NT(1e-10);
+
+    int n = G.rows(), k = G.cols();
+    revolving_door_combinations subset(k, n, first);
+    std::vector<int> slot(k, -1);
+    VT col_norms = G.colwise().norm().transpose();
+
+    MT M(n, n), Minv(n, n);
+    VT u(n), row(n);
+    for (int j = 0; j < n; ++j) {
+        slot[subset[j]] = j;
+        M.col(j) = G.col(subset[j]);
+    }
+
+    NT det = 0, sum = 0, compensation = 0;
+    bool has_inverse = false;
+    unsigned int since_refresh = 0;
+
+    // Hadamard's bound, the determinant is negligible when far below it
+    auto hadamard_bound = [&]() {
+        NT bound = 1;
+        for (int j = 0; j < n; ++j) bound *= col_norms(subset[j]);
+        return bound;
+    };
+    auto refactor = [&]() {
+        Eigen::PartialPivLU<MT> lu(M);
+        det = lu.determinant();
+        has_inverse = std::abs(det) > singular_tol * hadamard_bound();
+        if (has_inverse) Minv = lu.inverse();
+        since_refresh = 0;
+    };
+
+    refactor();
+    for (std::uint64_t r = first; r < last; ++r) {
+        NT term = std::abs(det);
+        NT t = sum + term;
+        compensation += (std::abs(sum) >= term) ? (sum - t) + term : (term - t) + sum;
+        sum = t;
+
+        int out, in;
+        if (r + 1 == last || !subset.next(out, in)) break;
+
+        int s = slot[out];
+        slot[out] = -1;
+        slot[in] = s;
+        M.col(s) = G.col(in);
+
+        if (!has_inverse || ++since_refresh >= refresh_period) {
+            refactor();
+            continue;
+        }
+
+        u.noalias() = Minv * M.col(s);
+        NT us = u(s);
+        det *= us;
+        if (std::abs(det) <= singular_tol * hadamard_bound()) {
+            refactor();
+            continue;
+        }
+        row = Minv.row(s).transpose();
+        u(s) -= NT(1);
+        Minv.noalias() -= (u / us) * row.transpose();
+    }
+    return sum + compensation;
+}
+
+
+// Exact volume of a zonotope: 2^n times the sum of |det| of all the n x n
+// submatrices of the generators. The subsets of generators are streamed in
+// revolving-door order, split into chunks that are summed in parallel, and the
+// chunk sums are reduced in a fixed order, so the result does not depend on the
+// number of threads and no subset is ever stored.
 template <typename NT, typename Polytope>
 NT exact_zonotope_vol(const Polytope &ZP){
 
     typedef typename Polytope::MT 	MT;
-    typedef std::vector< std::vector<int> >::iterator  IntMatIt;
-    typedef std::vector<int>::iterator  IntIt;
-
-    int n = ZP.dimension(), col, k = ZP.num_of_generators();
-    MT V1 = ZP.get_mat().transpose(), SubV(n,n), V(n, 2*k);
-    V << V1, -V1;
-    NT vol = 0.0;
-
-    std::vector< std::vector<int> > combs = comb(2*k, n);
-    IntMatIt iter_combs;
-    IntIt it;
-
-    iter_combs = combs.begin();
-    for ( ;  iter_combs!=combs.end(); ++iter_combs) {
-        it = (*iter_combs).begin();
-        col = 0;
-        // construct all the nxn submatrices
-        for ( ; it!=(*iter_combs).end(); ++it, ++col) {
-            SubV.col(col) = V.col(*it);
-        }
-        vol += std::abs(SubV.determinant());
+
+    int n = ZP.dimension(), k = ZP.num_of_generators();
+    MT G = ZP.get_mat().transpose();
+
+    std::uint64_t num_subsets = binomial_coefficient(k, n);
+    if (num_subsets == 0) return NT(0);
+
+    const std::uint64_t min_chunk = 256, max_chunks = 1024;
+    std::uint64_t num_chunks = std::min(max_chunks, (num_subsets + min_chunk - 1) / min_chunk);
+    std::uint64_t chunk = (num_subsets + num_chunks - 1) / num_chunks;
+    num_chunks = (num_subsets + chunk - 1) / chunk;
+    std::vector<NT> chunk_sums(num_chunks, NT(0));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long long i = 0; i < (long long) num_chunks; ++i) {
+        std::uint64_t first = std::uint64_t(i) * chunk;
+        chunk_sums[i] = sum_of_abs_determinants<NT>(G, first,
+                                                    std::min(num_subsets, first + chunk));
+    }
+
+    NT vol = 0, compensation = 0;
+    for (NT const& s : chunk_sums) {
+        NT t = vol + s;
+        compensation += (std::abs(vol) >= std::abs(s)) ? (vol - t) + s : (s - t) + vol;
+        vol = t;
     }
-    return vol;
+    return std::ldexp(vol + compensation, n);
 }
 
 template <typename NT>
@@ -18,6 +18,20 @@ struct PushBackWalkPolicy
     }
 };
 
+// Stores the i-th generated point in the i-th column of a preallocated matrix
+struct MatrixColumnWalkPolicy
+{
+    template <typename MT, typename Point>
+    void apply(MT &randPoints,
+               Point &p)
+    {
+        randPoints.col(_col++) = p.getCoefficients();
+    }
+
+private :
+    unsigned int _col = 0;
+};
+
 template <typename BallPoly>
 struct CountingWalkPolicy
 {
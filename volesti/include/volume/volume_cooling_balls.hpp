@@ -43,6 +43,7 @@ struct cooling_ball_parameters
         ,   N(125)
         ,   nu(10)
         ,   window2(false)
+        ,   recycle_samples(false)
     {}
 
     NT lb;
@@ -54,6 +55,7 @@ struct cooling_ball_parameters
     int N;
     int nu;
     bool window2;
+    bool recycle_samples; // seed the ratio estimators with the samples of the ball sequence
 };
 
 /// Helpers
@@ -271,6 +273,20 @@ bool get_next_zonotopeball(std::vector<ball>& BallSet,
 }
 
 
+// Keep the last (at most) num_samples points of a phase of the ball sequence, in
+// the order they were generated, to seed the ratio estimation of the phase
+template <typename PointList, typename Point>
+void keep_last_samples(PointList const& randPoints,
+                       int const& num_samples,
+                       std::vector<std::vector<Point>>& phase_samples)
+{
+    int skip = std::max(0, int(randPoints.size()) - num_samples);
+    auto pit = randPoints.begin();
+    std::advance(pit, skip);
+    phase_samples.emplace_back(pit, randPoints.end());
+}
+
+
 template
 <
     typename RandomPointGenerator,
@@ -287,7 +303,8 @@ bool get_sequence_of_polytopeballs(Polytope &P,
                                    NT const& radius,
                                    unsigned int const& walk_length,
                                    cooling_ball_parameters<NT> const& parameters,
-                                   RNG& rng)
+                                   RNG& rng,
+                                   std::vector<std::vector<typename Polytope::PointType>>& phase_samples)
 {
     typedef typename Polytope::PointType Point;
     bool fail;
@@ -308,6 +325,7 @@ bool get_sequence_of_polytopeballs(Polytope &P,
     PushBackWalkPolicy push_back_policy;
     RandomPointGenerator::apply(P, q, Ntot, walk_length,
                                 randPoints, push_back_policy, rng);
+    keep_last_samples(randPoints, parameters.win_len, phase_samples);
 
     if (check_convergence<Point>(B0, randPoints,
                                  fail, ratio, parameters.nu,
@@ -332,6 +350,7 @@ bool get_sequence_of_polytopeballs(Polytope &P,
 
         RandomPointGenerator::apply(zb_it, q, Ntot, walk_length,
                                     randPoints, push_back_policy, rng);
+        keep_last_samples(randPoints, parameters.win_len, phase_samples);
         if (check_convergence<Point>(B0, randPoints, fail, ratio, parameters.nu,
                                      false, true, parameters))
         {
@@ -349,6 +368,30 @@ bool get_sequence_of_polytopeballs(Polytope &P,
 }
 
 
+template
+<
+    typename RandomPointGenerator,
+    typename PolyBall,
+    typename ball,
+    typename Polytope,
+    typename NT,
+    typename RNG
+>
+bool get_sequence_of_polytopeballs(Polytope &P,
+                                   std::vector<ball>& BallSet,
+                                   std::vector<NT>& ratios,
+                                   int const& Ntot,
+                                   NT const& radius,
+                                   unsigned int const& walk_length,
+                                   cooling_ball_parameters<NT> const& parameters,
+                                   RNG& rng)
+{
+    std::vector<std::vector<typename Polytope::PointType>> phase_samples;
+    return get_sequence_of_polytopeballs<RandomPointGenerator, PolyBall>
+            (P, BallSet, ratios, Ntot, radius, walk_length, parameters, rng, phase_samples);
+}
+
+
 ////////////////////////////////////
 ///
 /// ratio estimation
@@ -472,6 +515,76 @@ NT estimate_ratio(PolyBall1 &Pb1,
     return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
 }
 
+// Set the counts of a ratio estimation that continues the sample stream of a phase
+// of the ball sequence: Ntot samples of Pb1 were drawn there and a fraction ratio of
+// them lies in Pb2. The last num_recycled of them are kept in samples and are not
+// counted here, the caller replays them through the sliding window.
+template <typename PolyBall2, typename Point, typename NT, typename RatioParameters>
+void set_recycled_counts(PolyBall2 &Pb2,
+                         std::vector<Point> const& samples,
+                         int const& num_recycled,
+                         NT const& ratio,
+                         int const& Ntot,
+                         RatioParameters& ratio_parameters)
+{
+    if (num_recycled == 0) return;
+
+    size_t in_recycled = 0;
+    for (auto it = samples.end() - num_recycled; it != samples.end(); ++it)
+    {
+        if (Pb2.is_in(*it) == -1) in_recycled++;
+    }
+    size_t count_in = size_t(std::round(NT(Ntot) * ratio));
+    ratio_parameters.tot_count = Ntot - num_recycled;
+    ratio_parameters.count_in = (count_in > in_recycled) ? count_in - in_recycled : 0;
+}
+
+// Same as above but the estimation starts from the samples of Pb1 that the ball
+// sequence generated: they are replayed through the sliding window and the walk
+// continues from the last one instead of starting from the center
+template
+<
+        typename WalkType,
+        typename Point,
+        typename PolyBall1,
+        typename PolyBall2,
+        typename NT,
+        typename RNG
+>
+NT estimate_ratio(PolyBall1 &Pb1,
+                  PolyBall2 &Pb2,
+                  NT const& ratio,
+                  NT const& error,
+                  unsigned int const& W,
+                  unsigned int const& Ntot,
+                  unsigned int const& walk_length,
+                  RNG& rng,
+                  std::vector<Point> const& samples)
+{
+    estimate_ratio_parameters<NT> ratio_parameters(W, Ntot, ratio);
+    int num_recycled = std::min(samples.size(), size_t(std::min(W, Ntot)));
+    set_recycled_counts(Pb2, samples, num_recycled, ratio, int(Ntot), ratio_parameters);
+
+    for (auto it = samples.end() - num_recycled; it != samples.end(); ++it)
+    {
+        if (estimate_ratio_generic(Pb2, *it, error, ratio_parameters))
+        {
+            return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
+        }
+    }
+
+    unsigned int n = Pb1.dimension();
+    Point p = (num_recycled > 0) ? samples.back() : Point(n);
+    WalkType walk(Pb1, p, rng);
+
+    do
+    {
+        walk.apply(Pb1, p, walk_length, rng);
+    } while(!estimate_ratio_generic(Pb2, p, error, ratio_parameters));
+
+    return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
+}
+
 template
 <       typename Point,
         typename ball,
@@ -687,6 +800,60 @@ NT estimate_ratio_interval(PolyBall1 &Pb1,
     return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
 }
 
+// Same as above but the estimation starts from the samples of Pb1 that the ball
+// sequence generated: they fill the sliding window and the walk continues from
+// the last one instead of starting from the center
+template
+<
+        typename WalkType,
+        typename Point,
+        typename PolyBall1,
+        typename PolyBall2,
+        typename NT,
+        typename RNG
+>
+NT estimate_ratio_interval(PolyBall1 &Pb1,
+                           PolyBall2 &Pb2,
+                           NT const& ratio,
+                           NT const& error,
+                           int const& W,
+                           int const& Ntot,
+                           NT const& prob,
+                           unsigned int const& walk_length,
+                           RNG& rng,
+                           std::vector<Point> const& samples)
+{
+    estimate_ratio_interval_parameters<NT> ratio_parameters(W, Ntot, ratio);
+    boost::math::normal dist(0.0, 1.0);
+    NT zp = boost::math::quantile(boost::math::complement(dist, (1.0 - prob)/2.0));
+
+    int num_recycled = std::min(int(samples.size()), std::min(W, Ntot));
+    set_recycled_counts(Pb2, samples, num_recycled, ratio, Ntot, ratio_parameters);
+
+    for (auto it = samples.end() - num_recycled; it != samples.end(); ++it)
+    {
+        full_sliding_window(Pb2, *it, ratio_parameters);
+    }
+
+    unsigned int n = Pb1.dimension();
+    Point p = (num_recycled > 0) ? samples.back() : Point(n);
+    WalkType walk(Pb1, p, rng);
+
+    for (int i = num_recycled; i < ratio_parameters.W; ++i)
+    {
+        walk.apply(Pb1, p, walk_length, rng);
+        full_sliding_window(Pb2, p, ratio_parameters);
+    }
+
+    ratio_parameters.mean = ratio_parameters.sum / NT(ratio_parameters.W);
+
+    do {
+        walk.apply(Pb1, p, walk_length, rng);
+    } while (!estimate_ratio_interval_generic(Pb2, p, error, zp, ratio_parameters));
+
+    return NT(ratio_parameters.count_in) / NT(ratio_parameters.tot_count);
+}
+
 template
 <
     typename WalkTypePolicy,
@@ -698,7 +865,8 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                                RandomNumberGenerator &rng,
                                                double const& error = 0.1,
                                                unsigned int const& walk_length = 1,
-                                               unsigned int const& win_len = 300)
+                                               unsigned int const& win_len = 300,
+                                               bool const& recycle_samples = false)
 {
     typedef typename Polytope::PointType Point;
     typedef typename Point::FT NT;
@@ -716,6 +884,7 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
 
     auto P(Pin);
     cooling_ball_parameters<NT> parameters(win_len);
+    parameters.recycle_samples = recycle_samples;
 
     int n = P.dimension();
     NT prob = parameters.p;
@@ -729,6 +898,7 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
 
     std::vector<BallType> BallSet;
     std::vector<NT> ratios;
+    std::vector<std::vector<Point>> phase_samples;
 
     // move the chebychev center to the origin
     // and apply the same shifting to the polytope
@@ -740,11 +910,18 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
             PolyBall
           >(P, BallSet, ratios,
             N_times_nu, radius, walk_length,
-            parameters, rng) )
+            parameters, rng, phase_samples) )
     {
         return std::pair<NT, NT> (-1.0, 0.0);
     }
 
+    // phase_samples[0] are samples of P and phase_samples[i] samples of P
+    // intersected with BallSet[i-1]; they seed the ratio estimation of the phase
+    if (!parameters.recycle_samples)
+    {
+        for (auto &samples : phase_samples) samples.clear();
+    }
+
     NT vol = (NT(n)/NT(2) * std::log(M_PI)) + NT(n)*std::log((*(BallSet.end() - 1)).radius()) - log_gamma_function(NT(n) / NT(2) + 1);
 
     int mm = BallSet.size() + 1;
@@ -762,6 +939,7 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                                         prob, rng));
     auto balliter = BallSet.begin();
     auto ratioiter = ratios.begin();
+    auto samplesiter = phase_samples.begin();
 
     er1 = er1 / std::sqrt(NT(mm) - 1.0);
 
@@ -777,7 +955,8 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                       N_times_nu,
                                       prob,
                                       walk_length,
-                                      rng))
+                                      rng,
+                                      *samplesiter))
             : std::log(NT(1) / estimate_ratio
                     <WalkType, Point>(P,
                                       *balliter,
@@ -786,10 +965,12 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                       parameters.win_len,
                                       N_times_nu,
                                       walk_length,
-                                      rng));
+                                      rng,
+                                      *samplesiter));
     }
+    ++samplesiter;
 
-    for ( ; balliter < BallSet.end() - 1; ++balliter, ++ratioiter)
+    for ( ; balliter < BallSet.end() - 1; ++balliter, ++ratioiter, ++samplesiter)
     {
         PolyBall Pb(P, *balliter);
         vol += (!parameters.window2) ?
@@ -800,16 +981,18 @@ std::pair<double, double> volume_cooling_balls(Polytope& Pin,
                                                   er1, parameters.win_len,
                                                   N_times_nu,
                                                   prob, walk_length,
-                                                  rng))
+                                                  rng,
+                                                  *samplesiter))
                   : std::log(NT(1) / estimate_ratio
                                 <WalkType, Point>(Pb,
-                                                  *balliter,
-                                                  *ratioiter,
+                                                  *(balliter + 1),
+                                                  *(ratioiter + 1),
                                                   er1,
                                                   parameters.win_len,
                                                   N_times_nu,
                                                   walk_length,
-                                                  rng));
+                                                  rng,
+                                                  *samplesiter));
     }
 
     return std::pair<NT, NT> (vol, std::exp(vol));
@@ -17,6 +17,10 @@
 #include <list>
 #include <math.h>
 #include <chrono>
+#include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "cartesian_geom/cartesian_kernel.h"
 #include "random_walks/gaussian_helpers.hpp"
@@ -177,14 +181,17 @@ NT get_next_gaussian(Polytope& P,
     return last_a * std::pow(ratio, k);
 }
 
-// Compute the sequence of spherical gaussians
+// Compute the sequence of spherical gaussians.
+// phase_fixed(i, a_i, a_{i+1}, q) is called as soon as the gaussians of the i-th
+// ratio are final, where q is the last point the schedule search sampled from a_i
 template
 <
     typename WalkType,
     typename RandomPointGenerator,
     typename Polytope,
     typename NT,
-    typename RandomNumberGenerator
+    typename RandomNumberGenerator,
+    typename PhaseFixed
 >
 void compute_annealing_schedule(Polytope& P,
                                 NT const& ratio,
@@ -195,7 +202,8 @@ void compute_annealing_schedule(Polytope& P,
                                 NT const& chebychev_radius,
                                 NT const& error,
                                 std::vector<NT>& a_vals,
-                                RandomNumberGenerator& rng)
+                                RandomNumberGenerator& rng,
+                                PhaseFixed&& phase_fixed)
 {
     typedef typename Polytope::PointType Point;
     typedef typename Polytope::VT VT;
@@ -220,6 +228,7 @@ void compute_annealing_schedule(Polytope& P,
 #endif
 
     Point p(n);
+    std::vector<Point> last_points;
 
     while (true)
     {
@@ -245,25 +254,55 @@ void compute_annealing_schedule(Polytope& P,
             curr_its += 1.0;
             curr_fn += eval_exp(p, next_a) / eval_exp(p, a_vals[it]);
         }
+        last_points.push_back(p);
 
         // Remove the last gaussian.
         // Set the last a_i equal to zero
         if (next_a>0 && curr_fn/curr_its>(1.0+tol))
         {
             a_vals.push_back(next_a);
+            if (it > 0) phase_fixed(it-1, a_vals[it-1], a_vals[it], last_points[it-1]);
             it++;
         } else if (next_a <= 0)
         {
             a_vals.push_back(a_stop);
+            if (it > 0) phase_fixed(it-1, a_vals[it-1], a_vals[it], last_points[it-1]);
+            phase_fixed(it, a_vals[it], a_vals[it+1], last_points[it]);
             it++;
             break;
         } else {
             a_vals[it] = a_stop;
+            if (it > 0) phase_fixed(it-1, a_vals[it-1], a_vals[it], last_points[it-1]);
             break;
         }
     }
 }
 
+template
+<
+    typename WalkType,
+    typename RandomPointGenerator,
+    typename Polytope,
+    typename NT,
+    typename RandomNumberGenerator
+>
+void compute_annealing_schedule(Polytope& P,
+                                NT const& ratio,
+                                NT const& C,
+                                NT const& frac,
+                                unsigned int const& N,
+                                unsigned int const& walk_length,
+                                NT const& chebychev_radius,
+                                NT const& error,
+                                std::vector<NT>& a_vals,
+                                RandomNumberGenerator& rng)
+{
+    typedef typename Polytope::PointType Point;
+    compute_annealing_schedule<WalkType, RandomPointGenerator>
+            (P, ratio, C, frac, N, walk_length, chebychev_radius, error, a_vals, rng,
+             [](unsigned int, NT, NT, Point const&) {});
+}
+
 template <typename NT>
 struct gaussian_annealing_parameters
 {
@@ -282,6 +321,204 @@ struct gaussian_annealing_parameters
     unsigned int W;
 };
 
+
+// Sliding window convergence test of a ratio estimation: the estimation has
+// converged when the last W running means are within relative distance eps/2
+template <typename NT>
+struct ratio_window_test
+{
+    ratio_window_test(unsigned int const& W, NT const& eps)
+        :   last_W(W, NT(0))
+        ,   curr_eps(eps)
+        ,   min_val(std::numeric_limits<NT>::min())
+        ,   max_val(std::numeric_limits<NT>::max())
+        ,   min_index(W-1)
+        ,   max_index(W-1)
+        ,   index(0)
+    {}
+
+    // push the current running mean, returns true when the test is satisfied
+    bool push(NT const& val)
+    {
+        typename std::vector<NT>::iterator minmaxIt;
+        unsigned int W = last_W.size();
+        bool done = false;
+
+        last_W[index] = val;
+        if (val <= min_val)
+        {
+            min_val = val;
+            min_index = index;
+        } else if (min_index == index)
+        {
+            minmaxIt = std::min_element(last_W.begin(), last_W.end());
+            min_val = *minmaxIt;
+            min_index = std::distance(last_W.begin(), minmaxIt);
+        }
+
+        if (val >= max_val)
+        {
+            max_val = val;
+            max_index = index;
+        } else if (max_index == index)
+        {
+            minmaxIt = std::max_element(last_W.begin(), last_W.end());
+            max_val = *minmaxIt;
+            max_index = std::distance(last_W.begin(), minmaxIt);
+        }
+
+        if (converged())
+        {
+            done=true;
+        }
+
+        index = index%W + 1;
+        if (index == W) index = 0;
+        return done;
+    }
+
+    bool converged() const
+    {
+        return (max_val-min_val)/max_val <= curr_eps/2.0;
+    }
+
+    std::vector<NT> last_W;
+    NT curr_eps;
+    NT min_val;
+    NT max_val;
+    unsigned int min_index;
+    unsigned int max_index;
+    unsigned int index;
+};
+
+
+// Chains that estimate the ratio of the integrals of the gaussians a_next and a_i
+// over P. Every chain walks in blocks of steps on its own thread; after each block
+// the ratio samples of all the chains are pooled in chain order into the running
+// mean and the sliding window test, so the result depends on the seeds of the
+// chains but not on the number of threads. The estimation can be resumed with a
+// smaller error, which the pipelined annealing uses when it learns the final
+// number of ratios.
+template
+<
+    typename WalkType,
+    typename Point,
+    typename NT,
+    typename RandomNumberGenerator
+>
+struct gaussian_ratio_chains
+{
+    template <typename Polytope>
+    gaussian_ratio_chains(Polytope& P,
+                          std::vector<Point> const& starts,
+                          std::vector<RandomNumberGenerator> const& chain_rngs,
+                          NT const& a_i,
+                          NT const& a_next,
+                          NT const& radius,
+                          unsigned int const& W,
+                          unsigned int const& walk_length)
+        :   points(starts)
+        ,   rngs(chain_rngs)
+        ,   _a_i(a_i)
+        ,   _a_next(a_next)
+        ,   _walk_length(walk_length)
+        ,   _block(std::max(1u, W / (10 * (unsigned int) starts.size())))
+        ,   _window(W, NT(1))
+        ,   fn(0)
+        ,   its(0)
+    {
+        unsigned int n = P.dimension();
+        walks.reserve(points.size());
+        for (unsigned int k = 0; k < points.size(); k++)
+        {
+            walks.emplace_back(P, points[k], a_i, rngs[k]);
+            update_delta<WalkType>
+                    ::apply(walks[k], 4.0 * radius
+                             / std::sqrt(std::max(NT(1.0), a_i) * NT(n)));
+        }
+    }
+
+    // sample until the sliding window test with error curr_eps is satisfied
+    template <typename Polytope>
+    void estimate(Polytope& P, NT const& curr_eps)
+    {
+        int num_chains = points.size();
+        std::vector<NT> samples(_block * num_chains);
+        _window.curr_eps = curr_eps;
+        bool done = its > 0 && _window.converged();
+
+        while (!done)
+        {
+            // The chains are scheduled on the default team. In the pipelined mode the
+            // phases already run in parallel, so there the chains of a phase run on
+            // the thread of the phase instead of a nested team
+            #pragma omp parallel for schedule(dynamic) if(!omp_in_parallel())
+            for (int k = 0; k < num_chains; k++)
+            {
+                for (unsigned int t = 0; t < _block; t++)
+                {
+                    walks[k].apply(P, points[k], _a_i, _walk_length, rngs[k]);
+                    samples[t * num_chains + k] = eval_exp(points[k], _a_next)
+                                                / eval_exp(points[k], _a_i);
+                }
+            }
+
+            for (auto sit = samples.begin(); sit != samples.end(); ++sit)
+            {
+                its += 1.0;
+                fn += *sit;
+                if (_window.push(fn / its))
+                {
+                    done = true;
+                }
+            }
+        }
+    }
+
+    std::vector<Point> points;
+    std::vector<RandomNumberGenerator> rngs;
+
+private:
+    std::vector<WalkType> walks;
+    NT _a_i;
+    NT _a_next;
+    unsigned int _walk_length;
+    unsigned int _block;
+    ratio_window_test<NT> _window;
+
+public:
+    NT fn;
+    NT its;
+};
+
+
+// The facet neighborhood index of an H-polytope is updated inside its const boundary
+// oracles, so it must be off when several chains share the polytope
+template <typename Polytope>
+auto disable_facet_index(Polytope& P, int) -> decltype(P.set_facet_index(0), void())
+{
+    P.set_facet_index(0);
+}
+
+template <typename Polytope>
+void disable_facet_index(Polytope&, long) {}
+
+
+// copies of rng with seeds drawn from rng, one for each chain
+template <typename RandomNumberGenerator>
+std::vector<RandomNumberGenerator> seed_chain_rngs(RandomNumberGenerator& rng,
+                                                   unsigned int const& num_chains)
+{
+    std::vector<RandomNumberGenerator> chain_rngs(num_chains, rng);
+    for (unsigned int k = 0; k < num_chains; k++)
+    {
+        chain_rngs[k].set_seed(static_cast<unsigned int>(rng.sample_urdist()
+                               * std::numeric_limits<unsigned int>::max()));
+    }
+    return chain_rngs;
+}
+
+
 template
 <
     typename WalkTypePolicy,
@@ -292,7 +529,9 @@ template
 double volume_cooling_gaussians(Polytope& Pin,
                                 RandomNumberGenerator& rng,
                                 double const& error = 0.1,
-                                unsigned int const& walk_length = 1)
+                                unsigned int const& walk_length = 1,
+                                unsigned int const& num_chains = 1,
+                                bool const& pipelined = false)
 {
     typedef typename Polytope::PointType Point;
     typedef typename Point::FT NT;
@@ -303,11 +542,16 @@ double volume_cooling_gaussians(Polytope& Pin,
                                                     RandomNumberGenerator
                                               > WalkType;
     typedef GaussianRandomPointGenerator<WalkType> RandomPointGenerator;
+    typedef gaussian_ratio_chains<WalkType, Point, NT, RandomNumberGenerator> RatioChains;
 
     //const NT maxNT = std::numeric_limits<NT>::max();//1.79769e+308;
     //const NT minNT = std::numeric_limits<NT>::min();//-1.79769e+308;
 
     auto P(Pin); //copy and work with P because we are going to shift
+    if (num_chains > 1 || pipelined)
+    {
+        disable_facet_index(P, 0);
+    }
     unsigned int n = P.dimension();
     unsigned int m = P.num_of_hyperplanes();
     gaussian_annealing_parameters<NT> parameters(P.dimension());
@@ -334,12 +578,45 @@ double volume_cooling_gaussians(Polytope& Pin,
     NT ratio = parameters.ratio;
     NT C = parameters.C;
     unsigned int N = parameters.N;
+    unsigned int W = parameters.W;
+    std::vector<std::unique_ptr<RatioChains>> phases;
 
-    compute_annealing_schedule
-    <
-        WalkType,
-        RandomPointGenerator
-    >(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng);
+    if (pipelined)
+    {
+        // Start the ratio chains of a phase as soon as both of its gaussians are
+        // fixed, from the last point the schedule search sampled from the first one,
+        // while the search goes on. The number of ratios is not known yet, so they
+        // run with the error of a shorter schedule and are resumed below.
+        Polytope* Pptr = &P;
+        unsigned int chains_per_phase = std::max(1u, num_chains);
+
+        #pragma omp parallel
+        #pragma omp single
+        {
+            compute_annealing_schedule
+            <
+                WalkType,
+                RandomPointGenerator
+            >(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng,
+              [&](unsigned int i, NT a_i, NT a_next, Point const& q)
+            {
+                phases.emplace_back(new RatioChains(P, std::vector<Point>(chains_per_phase, q),
+                                                    seed_chain_rngs(rng, chains_per_phase),
+                                                    a_i, a_next, radius, W, walk_length));
+                RatioChains* chains = phases.back().get();
+                NT eps = error / std::sqrt(NT(i + 1));
+
+                #pragma omp task firstprivate(chains, eps, Pptr)
+                chains->estimate(*Pptr, eps);
+            });
+        }
+    } else {
+        compute_annealing_schedule
+        <
+            WalkType,
+            RandomPointGenerator
+        >(P, ratio, C, parameters.frac, N, walk_length, radius, error, a_vals, rng);
+    }
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"All the variances of schedule_annealing computed in = "
@@ -352,9 +629,7 @@ double volume_cooling_gaussians(Polytope& Pin,
 #endif
 
     // Initialization for the approximation of the ratios
-    unsigned int W = parameters.W;
     unsigned int mm = a_vals.size()-1;
-    std::vector<NT> last_W2(W,0);
     std::vector<NT> fn(mm,0);
     std::vector<NT> its(mm,0);
     VT lamdas;
@@ -366,74 +641,81 @@ double volume_cooling_gaussians(Polytope& Pin,
     typedef typename std::vector<NT>::iterator viterator;
     viterator itsIt = its.begin();
     viterator avalsIt = a_vals.begin();
-    viterator minmaxIt;
 
 #ifdef VOLESTI_DEBUG
     std::cout<<"volume of the first gaussian = "<<vol<<"\n"<<std::endl;
     std::cout<<"computing ratios..\n"<<std::endl;
 #endif
 
+    if (pipelined)
+    {
+        // resume the chains of all the phases with the error of the final schedule
+        NT curr_eps = error/std::sqrt((NT(mm)));
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int k = 0; k < (int) mm; k++)
+        {
+            phases[k]->estimate(P, curr_eps);
+        }
+        for (unsigned int k = 0; k < mm; k++)
+        {
+            fn[k] = phases[k]->fn;
+            its[k] = phases[k]->its;
+        }
+    }
+
+    // chains of the multi-chain ratio estimation, all of them start from the
+    // Chebychev center and carry their states over from phase to phase
+    std::vector<Point> chain_points;
+    std::vector<RandomNumberGenerator> chain_rngs;
+    if (num_chains > 1 && !pipelined)
+    {
+        chain_points.assign(num_chains, p);
+        chain_rngs = seed_chain_rngs(rng, num_chains);
+    }
+
     //iterate over the number of ratios
     for (viterator fnIt = fn.begin();
          fnIt != fn.end();
          fnIt++, itsIt++, avalsIt++, i++)
     {
-        //initialize convergence test
-        bool done = false;
         NT curr_eps = error/std::sqrt((NT(mm)));
-        NT min_val = std::numeric_limits<NT>::min();
-        NT max_val = std::numeric_limits<NT>::max();
-        unsigned int min_index = W-1;
-        unsigned int max_index = W-1;
-        unsigned int index = 0;
-        unsigned int min_steps = 0;
-        std::vector<NT> last_W = last_W2;
-
-        // Set the radius for the ball walk
-        WalkType walk(P, p, *avalsIt, rng);
 
-        update_delta<WalkType>
-                ::apply(walk, 4.0 * radius
-                         / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
-
-        while (!done || (*itsIt)<min_steps)
+        if (num_chains > 1 && !pipelined)
         {
-            walk.apply(P, p, *avalsIt, walk_length, rng);
-
-            *itsIt = *itsIt + 1.0;
-            *fnIt = *fnIt + eval_exp(p,*(avalsIt+1)) / eval_exp(p,*avalsIt);
-            NT val = (*fnIt) / (*itsIt);
-
-            last_W[index] = val;
-            if (val <= min_val)
+            RatioChains chains(P, chain_points, chain_rngs, *avalsIt, *(avalsIt+1),
+                               radius, W, walk_length);
+            chains.estimate(P, curr_eps);
+            *fnIt = chains.fn;
+            *itsIt = chains.its;
+            chain_points = chains.points;
+            chain_rngs = chains.rngs;
+        } else if (!pipelined) {
+            //initialize convergence test
+            bool done = false;
+            unsigned int min_steps = 0;
+            ratio_window_test<NT> window(W, curr_eps);
+
+            // Set the radius for the ball walk
+            WalkType walk(P, p, *avalsIt, rng);
+
+            update_delta<WalkType>
+                    ::apply(walk, 4.0 * radius
+                             / std::sqrt(std::max(NT(1.0), *avalsIt) * NT(n)));
+
+            while (!done || (*itsIt)<min_steps)
             {
-                min_val = val;
-                min_index = index;
-            } else if (min_index == index)
-            {
-                minmaxIt = std::min_element(last_W.begin(), last_W.end());
-                min_val = *minmaxIt;
-                min_index = std::distance(last_W.begin(), minmaxIt);
-            }
+                walk.apply(P, p, *avalsIt, walk_length, rng);
 
-            if (val >= max_val)
-            {
-                max_val = val;
-                max_index = index;
-            } else if (max_index == index)
-            {
-                minmaxIt = std::max_element(last_W.begin(), last_W.end());
-                max_val = *minmaxIt;
-                max_index = std::distance(last_W.begin(), minmaxIt);
-            }
+                *itsIt = *itsIt + 1.0;
+                *fnIt = *fnIt + eval_exp(p,*(avalsIt+1)) / eval_exp(p,*avalsIt);
+                NT val = (*fnIt) / (*itsIt);
 
-            if ( (max_val-min_val)/max_val <= curr_eps/2.0 )
-            {
-                done=true;
+                if (window.push(val))
+                {
+                    done=true;
+                }
             }
-
-            index = index%W + 1;
-            if (index == W) index = 0;
         }
 #ifdef VOLESTI_DEBUG
         std::cout << "ratio " << i << " = " << (*fnIt) / (*itsIt)
@@ -463,10 +745,13 @@ template
 >
 double volume_cooling_gaussians(Polytope &Pin,
                                  double const& error = 0.1,
-                                 unsigned int const& walk_length = 1)
+                                 unsigned int const& walk_length = 1,
+                                 unsigned int const& num_chains = 1,
+                                 bool const& pipelined = false)
 {
     RandomNumberGenerator rng(Pin.dimension());
-    return volume_cooling_gaussians<WalkTypePolicy>(Pin, rng, error, walk_length);
+    return volume_cooling_gaussians<WalkTypePolicy>(Pin, rng, error, walk_length,
+                                                    num_chains, pipelined);
 }
 
 
@@ -479,12 +764,15 @@ template
 double volume_cooling_gaussians(Polytope &Pin,
                                 Cartesian<double>::Point const& interior_point,
                                 unsigned int const& walk_length = 1,
-                                double const& error = 0.1)
+                                double const& error = 0.1,
+                                unsigned int const& num_chains = 1,
+                                bool const& pipelined = false)
 {
     RandomNumberGenerator rng(Pin.dimension());
     Pin.set_interior_point(interior_point);
 
-    return volume_cooling_gaussians<WalkTypePolicy>(Pin, rng, error, walk_length);
+    return volume_cooling_gaussians<WalkTypePolicy>(Pin, rng, error, walk_length,
+                                                    num_chains, pipelined);
 }
 
 #endif // VOLUME_COOLING_GAUSSIANS_HPP
@@ -0,0 +1,65 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2018-2020 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+// Steps per second of the trapezoidal collocation solver on x'' = -x
+// for increasing dimension (requires the NLP oracles)
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Eigen/Eigen"
+#include <boost/random.hpp>
+
+#include "random_walks/random_walks.hpp"
+#include "ode_solvers/ode_solvers.hpp"
+
+int main()
+{
+    typedef double NT;
+    typedef Cartesian<NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef std::vector<Point> pts;
+    typedef PolynomialBasis<NT> bfunc;
+    typedef std::vector<NT> coeffs;
+    typedef HPolytope<Point> Hpolytope;
+    typedef std::vector<Hpolytope *> bounds;
+    typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+    typedef CollocationODESolver<Point, NT, Hpolytope, bfunc, func> Solver;
+
+    IsotropicQuadraticFunctor::parameters<NT> params;
+    params.order = 2;
+    func F(params);
+
+    bfunc phi(FUNCTION);
+    bfunc grad_phi(DERIVATIVE);
+
+    // Trapezoidal collocation
+    coeffs cs{0.0, 0.0, 1.0};
+    int num_steps = 200;
+
+    for (unsigned int dim = 10; dim <= 1000; dim *= 10) {
+        Point x0 = Point::all_ones(dim);
+        Point v0 = Point::all_ones(dim);
+
+        for (bool precompute : {false, true}) {
+            Solver c_solver = Solver(0, 0.1, pts{x0, v0}, F, bounds{NULL, NULL}, cs, phi, grad_phi);
+            c_solver.precompute = precompute;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            c_solver.steps(num_steps);
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            long ETA = (long)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+            std::cout << "Dimensionality: " << dim << ", cached factorization: " << precompute << std::endl;
+            std::cout << "Steps per second: " << NT(num_steps) / (NT(ETA) / NT(1000000)) << std::endl << std::endl;
+        }
+    }
+
+    return 0;
+}
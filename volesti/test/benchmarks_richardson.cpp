@@ -0,0 +1,86 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2020 Vissarion Fisikopoulos
+// Copyright (c) 2018-2020 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+// Time of the Richardson tableau rows (compute_rows) on an expensive oracle,
+// x' = -Q x with a dense Q, with one thread and with all the available threads
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Eigen/Eigen"
+#include <boost/random.hpp>
+
+#include "random_walks/random_walks.hpp"
+#include "ode_solvers/ode_solvers.hpp"
+
+template <typename Point>
+struct DenseLinearGradientFunctor {
+    typedef typename Point::FT NT;
+    typedef std::vector<Point> pts;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+
+    MT Q;
+
+    DenseLinearGradientFunctor(MT const& Q_) : Q(Q_) {};
+
+    Point operator() (unsigned int const& i, pts const& xs, NT const& t) const {
+        return Point(-(Q * xs[0].getCoefficients()));
+    }
+};
+
+int main()
+{
+    typedef double NT;
+    typedef Cartesian<NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef std::vector<Point> pts;
+    typedef HPolytope<Point> Hpolytope;
+    typedef std::vector<Hpolytope *> bounds;
+    typedef DenseLinearGradientFunctor<Point> func;
+    typedef RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func> Solver;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+
+    int max_threads = 1;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    std::cout << "Available threads: " << max_threads << std::endl << std::endl;
+
+    int num_repeats = 20;
+
+    for (unsigned int dim = 100; dim <= 1000; dim *= 10) {
+        MT B = MT::Random(dim, dim);
+        func F(MT(B.transpose() * B / NT(dim)) + MT::Identity(dim, dim));
+        Point x0 = Point::all_ones(dim);
+
+        for (int num_threads : {1, max_threads}) {
+#ifdef _OPENMP
+            omp_set_num_threads(num_threads);
+#endif
+            Solver r_solver = Solver(0, 0.01, pts{x0}, F, bounds{NULL});
+            r_solver.xs_prev = r_solver.xs;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < num_repeats; i++) {
+                r_solver.compute_rows(0, r_solver.MAX_TRIES);
+            }
+            auto stop = std::chrono::high_resolution_clock::now();
+
+            long ETA = (long)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+            std::cout << "Dimensionality: " << dim << ", threads: " << num_threads << std::endl;
+            std::cout << "Tableaux per second: " << NT(num_repeats) / (NT(ETA) / NT(1000000)) << std::endl << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -360,6 +360,9 @@ void benchmark_nuts_hmc(bool truncated) {
         }
         stop = std::chrono::high_resolution_clock::now();
         std::cout << "proportion of sucussfull steps: " << hmc.get_ratio_acceptance() << std::endl;
+        std::cout << "gradient evaluations per sample: " << NT(hmc.total_gradient_evaluations) / NT(n_samples)
+                  << ", last tree depth: " << hmc.tree_depth << std::endl;
+        CHECK(hmc.tree_depth <= hmc_params.max_tree_depth);
       }
       else
       {
@@ -376,6 +379,9 @@ void benchmark_nuts_hmc(bool truncated) {
         }
         stop = std::chrono::high_resolution_clock::now();
         std::cout << "proportion of sucussfull steps: " << hmc.get_ratio_acceptance() << std::endl;
+        std::cout << "gradient evaluations per sample: " << NT(hmc.total_gradient_evaluations) / NT(n_samples)
+                  << ", last tree depth: " << hmc.tree_depth << std::endl;
+        CHECK(hmc.tree_depth <= hmc_params.max_tree_depth);
       }
 
       std::cout << "PSRF: " << univariate_psrf<NT, VT>(samples).maxCoeff() << std::endl;
@@ -939,12 +945,90 @@ std::pair<Point, NT> read_inner_ball_(std::string filename) {
     return read_inner_ball<NT, Point>(inp);
 }
 
+template <typename NT>
+void test_batch_hmc() {
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT> RandomNumberGenerator;
+    typedef IsotropicQuadraticFunctor::GradientFunctor<Point> NegativeGradientFunctor;
+    typedef IsotropicQuadraticFunctor::FunctionFunctor<Point> NegativeLogprobFunctor;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+
+    IsotropicQuadraticFunctor::parameters<NT> params;
+    params.order = 2;
+
+    NegativeGradientFunctor F(params);
+    NegativeLogprobFunctor f(params);
+
+    RandomNumberGenerator rng(1);
+    unsigned int dim = 10, num_chains = 8, n_samples = 10000, n_burns = 1000;
+    HamiltonianMonteCarloWalk::parameters<NT, NegativeGradientFunctor> hmc_params(F, dim);
+    Hpolytope P = generate_cube<Hpolytope>(dim, false);
+
+    HamiltonianMonteCarloWalk::BatchWalk
+      <Point, Hpolytope, RandomNumberGenerator, NegativeGradientFunctor, NegativeLogprobFunctor>
+      hmc(&P, MT::Zero(dim, num_chains), F, f, hmc_params);
+
+    VT mean = VT::Zero(dim), second_moment = VT::Zero(dim);
+    for (unsigned int i = 0; i < n_burns + n_samples; i++) {
+      hmc.apply(rng, 3);
+      if (i >= n_burns) {
+        mean += hmc.X.rowwise().sum();
+        second_moment += hmc.X.array().square().matrix().rowwise().sum();
+      }
+    }
+    mean /= NT(n_samples * num_chains);
+    second_moment /= NT(n_samples * num_chains);
+
+    std::cout << "Discard ratio: " << hmc.get_discard_ratio() << std::endl;
+    std::cout << "Ergodic mean norm: " << mean.norm() << std::endl;
+    CHECK(mean.norm() < 0.1);
+    for (unsigned int j = 0; j < num_chains; j++) {
+      CHECK(P.is_in(hmc.get_point(j)) == -1);
+    }
+
+    // the moments of the scalar walk on the same density
+    typedef LeapfrogODESolver<Point, NT, Hpolytope, NegativeGradientFunctor> Solver;
+    Point x0(dim);
+    HamiltonianMonteCarloWalk::Walk
+      <Point, Hpolytope, RandomNumberGenerator, NegativeGradientFunctor, NegativeLogprobFunctor, Solver>
+      scalar_hmc(&P, x0, F, f, hmc_params);
+
+    VT scalar_mean = VT::Zero(dim), scalar_second_moment = VT::Zero(dim);
+    unsigned int n_scalar_samples = n_samples * num_chains;
+    for (unsigned int i = 0; i < n_burns + n_scalar_samples; i++) {
+      scalar_hmc.apply(rng, 3);
+      if (i >= n_burns) {
+        scalar_mean += scalar_hmc.x.getCoefficients();
+        scalar_second_moment += scalar_hmc.x.getCoefficients().array().square().matrix();
+      }
+    }
+    scalar_mean /= NT(n_scalar_samples);
+    scalar_second_moment /= NT(n_scalar_samples);
+
+    std::cout << "Mean difference to the scalar walk: " << (mean - scalar_mean).norm() << std::endl;
+    std::cout << "Second moments, batch: " << second_moment.mean()
+              << ", scalar: " << scalar_second_moment.mean() << std::endl;
+    CHECK((mean - scalar_mean).norm() < 0.1);
+    for (unsigned int i = 0; i < dim; i++) {
+      CHECK(std::abs(second_moment(i) - scalar_second_moment(i)) < 0.05 * scalar_second_moment(i));
+    }
+}
+
 template <typename NT>
 void call_test_hmc() {
   std::cout << "--- Testing Hamiltonian Monte Carlo" << std::endl;
   test_hmc<NT>();
 }
 
+template <typename NT>
+void call_test_batch_hmc() {
+  std::cout << "--- Testing batched Hamiltonian Monte Carlo" << std::endl;
+  test_batch_hmc<NT>();
+}
+
 template <typename NT>
 void call_test_uld() {
   std::cout << "--- Testing Underdamped Langevin Diffusion" << std::endl;
@@ -1271,6 +1355,10 @@ TEST_CASE("hmc") {
     call_test_hmc<double>();
 }
 
+TEST_CASE("batch_hmc") {
+    call_test_batch_hmc<double>();
+}
+
 TEST_CASE("uld") {
     call_test_uld<double>();
 }
@@ -217,6 +217,50 @@ template <typename NT> void test_richardson() {
   check_norm(bs_solver, 1000, NT(0));
 }
 
+template <typename NT> void test_richardson_accuracy() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef std::vector<Point> pts;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.order = 1;
+  params.alpha = 1;
+  func F(params);
+
+  Point q0 = Point::all_ones(1);
+  RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func> bs_solver =
+      RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func>(
+          0, 0.5, pts{q0}, F, bounds{NULL});
+
+  bs_solver.steps(4, true);
+  std::cout << "Rows used in the last step: " << bs_solver.num_rows << std::endl;
+  CHECK(std::abs(bs_solver.xs[0][0] - std::exp(-NT(2))) < 1e-6);
+
+  // With the step controller the solver stays on the solution for a coarse step
+  RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func> adaptive_solver =
+      RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func>(
+          0, 2.0, pts{q0}, F, bounds{NULL});
+  adaptive_solver.enable_adaptive();
+  adaptive_solver.steps(10, true);
+  std::cout << "Step size after adaptation: " << adaptive_solver.eta << std::endl;
+  CHECK(adaptive_solver.eta <= NT(2));
+  CHECK(std::abs(adaptive_solver.xs[0][0] - std::exp(-adaptive_solver.t)) < 1e-5);
+
+  // A step whose tableau does not converge is rejected and retried with a smaller step
+  RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func> rejecting_solver =
+      RichardsonExtrapolationODESolver<Point, NT, Hpolytope, func>(
+          0, 8.0, pts{q0}, F, bounds{NULL});
+  rejecting_solver.enable_adaptive();
+  rejecting_solver.steps(1, true);
+  std::cout << "Rejected steps: " << rejecting_solver.num_rejected << std::endl;
+  CHECK(rejecting_solver.num_rejected > 0);
+  CHECK(rejecting_solver.t < NT(8));
+  CHECK(rejecting_solver.error < rejecting_solver.tol);
+  CHECK(std::abs(rejecting_solver.xs[0][0] - std::exp(-rejecting_solver.t)) < 1e-6);
+}
+
 template <typename NT> void test_rk4() {
   typedef Cartesian<NT> Kernel;
   typedef typename Kernel::Point Point;
@@ -390,10 +434,176 @@ template <typename NT> void call_test_second_order() {
   test_leapfrog_constrained<NT>();
 }
 
+template <typename NT> void test_batch_leapfrog() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef std::vector<Point> pts;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+  unsigned int dim = 3;
+  unsigned int num_trajectories = 16;
+
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.order = 2;
+  func F(params);
+
+  MT X0 = MT::Zero(dim, num_trajectories);
+  MT V0 = MT::Random(dim, num_trajectories);
+
+  BatchLeapfrogODESolver<Point, NT, Hpolytope, func> batch_solver =
+      BatchLeapfrogODESolver<Point, NT, Hpolytope, func>(0, 0.01, std::vector<MT>{X0, V0}, F,
+                                                         bounds{NULL, NULL});
+  batch_solver.steps(1000, false);
+
+  // Every trajectory matches the one of the scalar solver
+  NT error = NT(0);
+  for (unsigned int j = 0; j < num_trajectories; j++) {
+    Point x0(dim);
+    Point v0(VT(V0.col(j)));
+    LeapfrogODESolver<Point, NT, Hpolytope, func> leapfrog_solver =
+        LeapfrogODESolver<Point, NT, Hpolytope, func>(0, 0.01, pts{x0, v0}, F,
+                                                      bounds{NULL, NULL});
+    leapfrog_solver.steps(1000, false);
+    error = std::max(error, (leapfrog_solver.xs[0].getCoefficients() - batch_solver.xs[0].col(j)).norm());
+  }
+
+  std::cout << "Max deviation from scalar leapfrog: " << error << std::endl;
+  CHECK(error < 1e-10);
+
+  // A first step with accepted = true starts from a zero gradient, as in the scalar solver
+  BatchLeapfrogODESolver<Point, NT, Hpolytope, func> accepted_solver =
+      BatchLeapfrogODESolver<Point, NT, Hpolytope, func>(0, 0.01, std::vector<MT>{X0, V0}, F,
+                                                         bounds{NULL, NULL});
+  accepted_solver.steps(10, true);
+  Point v0(VT(V0.col(0)));
+  LeapfrogODESolver<Point, NT, Hpolytope, func> accepted_leapfrog_solver =
+      LeapfrogODESolver<Point, NT, Hpolytope, func>(0, 0.01, pts{Point(dim), v0}, F,
+                                                    bounds{NULL, NULL});
+  accepted_leapfrog_solver.steps(10, true);
+  CHECK((accepted_leapfrog_solver.xs[0].getCoefficients() - accepted_solver.xs[0].col(0)).norm() < 1e-12);
+}
+
+template <typename NT> void test_batch_leapfrog_constrained() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+  unsigned int dim = 3;
+  unsigned int num_trajectories = 16;
+
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.order = 2;
+  func F(params);
+
+  Hpolytope P = generate_cube<Hpolytope>(dim, false);
+
+  MT X0 = MT::Zero(dim, num_trajectories);
+  MT V0 = 2 * MT::Random(dim, num_trajectories);
+
+  BatchLeapfrogODESolver<Point, NT, Hpolytope, func> batch_solver =
+      BatchLeapfrogODESolver<Point, NT, Hpolytope, func>(0, 0.01, std::vector<MT>{X0, V0}, F,
+                                                         bounds{&P, NULL});
+  batch_solver.steps(1000, false);
+
+  // Reflections preserve the energy 1/2 ||x||^2 + 1/2 ||v||^2 up to the integration error
+  for (unsigned int j = 0; j < num_trajectories; j++) {
+    CHECK(P.is_in(Point(VT(batch_solver.xs[0].col(j)))));
+    NT energy = batch_solver.xs[0].col(j).squaredNorm() + batch_solver.xs[1].col(j).squaredNorm();
+    CHECK(std::abs(energy - V0.col(j).squaredNorm()) < 0.05 * V0.col(j).squaredNorm());
+  }
+  std::cout << "Reflections: " << batch_solver.num_reflections << std::endl;
+  CHECK(batch_solver.num_reflections > 0);
+}
+
+template <typename NT> void test_batch_rk4() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef std::vector<Point> pts;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.alpha = 1;
+  params.order = 1;
+  func F(params);
+
+  MT X0 = MT::Ones(100, 8);
+  BatchRKODESolver<Point, NT, Hpolytope, func> rk_solver =
+      BatchRKODESolver<Point, NT, Hpolytope, func>(0, 0.1, std::vector<MT>{X0}, F, bounds{NULL});
+  rk_solver.steps(1000, true);
+
+  CHECK(rk_solver.xs[0].norm() < 1e-4);
+
+  // dx / dt = x in [-1, 1]
+  params.alpha = NT(-1);
+  Hpolytope P = generate_cube<Hpolytope>(1, false);
+  MT Y0 = 0.5 * MT::Ones(1, 8);
+  BatchRKODESolver<Point, NT, Hpolytope, func> rk_solver_constrained =
+      BatchRKODESolver<Point, NT, Hpolytope, func>(0, 0.01, std::vector<MT>{Y0}, F, bounds{&P});
+  rk_solver_constrained.steps(1000, true);
+
+  for (int j = 0; j < 8; j++) {
+    CHECK(std::abs(std::abs(rk_solver_constrained.xs[0](0, j)) - NT(1)) < 1e-2);
+  }
+}
+
+template <typename NT> void test_batch_euler() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef std::vector<Point> pts;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  typedef EulerODESolver<Point, NT, Hpolytope, func> Solver;
+  typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.alpha = 1;
+  params.order = 1;
+  func F(params);
+
+  std::vector<Solver> solvers;
+  for (int j = 0; j < 8; j++) {
+    solvers.push_back(Solver(0, 0.01, pts{Point::all_ones(10)}, F, bounds{NULL}));
+  }
+  BatchODESolver<Solver> batch_solver(solvers);
+
+  MT X0 = MT::Random(10, 8);
+  batch_solver.set_state(0, X0);
+  batch_solver.steps(2000, true);
+
+  MT X;
+  batch_solver.get_state(0, X);
+  CHECK(X.norm() < 1e-4);
+}
+
+template <typename NT> void call_test_richardson() {
+  std::cout << "--- Testing the accuracy of Richardson extrapolation" << std::endl;
+  test_richardson_accuracy<NT>();
+}
+
+template <typename NT> void call_test_batch() {
+  std::cout << "--- Testing batched solvers" << std::endl;
+  test_batch_leapfrog<NT>();
+  test_batch_leapfrog_constrained<NT>();
+  test_batch_rk4<NT>();
+  test_batch_euler<NT>();
+}
+
 TEST_CASE("first_order") { call_test_first_order<double>(); }
 
 TEST_CASE("second_order") { call_test_second_order<double>(); }
 
+TEST_CASE("richardson") { call_test_richardson<double>(); }
+
+TEST_CASE("batch") { call_test_batch<double>(); }
+
 #ifndef DISABLE_NLP_ORACLES
 
 template <typename NT> void test_collocation() {
@@ -514,6 +724,49 @@ template <typename NT> void test_collocation_constrained() {
   // target); CHECK(error < err);
 }
 
+template <typename NT> void test_collocation_precompute() {
+  typedef Cartesian<NT> Kernel;
+  typedef typename Kernel::Point Point;
+  typedef std::vector<Point> pts;
+  typedef PolynomialBasis<NT> bfunc;
+  typedef std::vector<NT> coeffs;
+  typedef HPolytope<Point> Hpolytope;
+  typedef std::vector<Hpolytope *> bounds;
+  typedef IsotropicQuadraticFunctor::GradientFunctor<Point> func;
+  IsotropicQuadraticFunctor::parameters<NT> params;
+  params.order = 2;
+  func F(params);
+
+  unsigned int dim = 10;
+  Point x0 = Point::all_ones(dim);
+  Point v0 = Point::all_ones(dim);
+
+  bfunc phi(FUNCTION);
+  bfunc grad_phi(DERIVATIVE);
+
+  // Trapezoidal collocation
+  coeffs cs{0.0, 0.0, 1.0};
+  CollocationODESolver<Point, NT, Hpolytope, bfunc, func> cached_solver =
+      CollocationODESolver<Point, NT, Hpolytope, bfunc, func>(
+          0, 0.1, pts{x0, v0}, F, bounds{NULL, NULL}, cs, phi, grad_phi);
+  CollocationODESolver<Point, NT, Hpolytope, bfunc, func> solver = cached_solver;
+  solver.precompute = false;
+
+  // the cached factorization must be refreshed when eta changes
+  for (NT eta : {NT(0.1), NT(0.05)}) {
+    cached_solver.eta = eta;
+    solver.eta = eta;
+    for (int i = 0; i < 50; i++) {
+      cached_solver.step();
+      solver.step();
+      for (unsigned int j = 0; j < 2; j++) {
+        NT error = (cached_solver.xs[j].getCoefficients() - solver.xs[j].getCoefficients()).norm();
+        CHECK(error <= 1e-12 * (1 + solver.xs[j].getCoefficients().norm()));
+      }
+    }
+  }
+}
+
 template <typename NT> void call_test_collocation() {
 
   std::cout << "--- Testing solution to dx / dt = -x w/ collocation"
@@ -525,6 +778,10 @@ template <typename NT> void call_test_collocation() {
             << std::endl;
   test_collocation_constrained<NT>();
   // test_integral_collocation_constrained<NT>();
+
+  std::cout << "--- Testing collocation with and without the cached factorization"
+            << std::endl;
+  test_collocation_precompute<NT>();
 }
 
 TEST_CASE("collocation") { call_test_collocation<double>(); }
@@ -26,6 +26,8 @@
 #include "generators/order_polytope_generator.h"
 
 #include "misc/poset.h"
+#include "random_walks/random_walks.hpp"
+#include "volume/volume_cooling_balls.hpp"
 #include "misc/misc.h"
 
 
@@ -122,6 +124,67 @@ void call_test_vec_mult() {
 }
 
 
+template <typename NT>
+void call_test_line_intersect_coord() {
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point Point;
+    typedef typename OrderPolytope<Point>::VT VT;
+    typedef typename Poset::RV RV;
+
+    // Create Poset, 6 elements
+    RV poset_data{{0, 1}, {0, 2}, {1, 3}, {2, 3}, {3, 5}, {4, 5}, {0, 5}};
+    Poset poset(6, poset_data);
+
+    for (int normalized = 0; normalized < 2; normalized++) {
+        OrderPolytope<Point> OP(poset);
+        if (normalized) OP.normalize();
+        HPolytope<Point> HP(OP.dimension(), OP.get_dense_mat(), OP.get_vec());
+        unsigned int d = OP.dimension();
+
+        // coordinate directions along a few steps of a coordinate walk
+        Point r(OP.inner_point()), r_prev = r;
+        VT lamdas_op, lamdas_hp;
+        std::pair<NT, NT> res_op = OP.line_intersect_coord(r, 0, lamdas_op);
+        std::pair<NT, NT> res_hp = HP.line_intersect_coord(r, 0, lamdas_hp);
+        CHECK(std::abs(res_op.first - res_hp.first) < 1e-12);
+        CHECK(std::abs(res_op.second - res_hp.second) < 1e-12);
+
+        unsigned int coord_prev = 0;
+        for (unsigned int k = 1; k < 4 * d; k++) {
+            unsigned int coord = (3 * k) % d;
+            r_prev = r;
+            r.set_coord(coord_prev, r[coord_prev] + 0.5 * (res_op.first + res_op.second));
+
+            res_op = OP.line_intersect_coord(r, r_prev, coord, coord_prev, lamdas_op);
+            res_hp = HP.line_intersect_coord(r, r_prev, coord, coord_prev, lamdas_hp);
+            CHECK(std::abs(res_op.first - res_hp.first) < 1e-12);
+            CHECK(std::abs(res_op.second - res_hp.second) < 1e-12);
+            CHECK((lamdas_op - lamdas_hp).norm() < 1e-12);
+            coord_prev = coord;
+        }
+    }
+}
+
+
+template <typename NT>
+void call_test_linear_extensions() {
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point Point;
+    typedef typename Poset::RV RV;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+
+    // Create Poset, 4 elements, a0 <= a1, a0 <= a2, a1 <= a3; it has 3 linear extensions
+    RV poset_data{{0, 1}, {0, 2}, {1, 3}};
+    Poset poset(4, poset_data);
+    OrderPolytope<Point> OP(poset);
+
+    NT volume = volume_cooling_balls<CDHRWalk, RNGType>(OP, 0.1, 10).second;
+    NT linear_extensions = volume * 24;
+    std::cout << "Estimated number of linear extensions: " << linear_extensions << std::endl;
+    CHECK(std::abs(linear_extensions - NT(3)) < NT(0.6));
+}
+
+
 template <typename NT>
 void call_test_basics() {
     typedef Cartesian<NT>    Kernel;
@@ -181,4 +244,12 @@ TEST_CASE("reflection") {
 
 TEST_CASE("vec_mult") {
     call_test_vec_mult<double>();
+}
+
+TEST_CASE("line_intersect_coord") {
+    call_test_line_intersect_coord<double>();
+}
+
+TEST_CASE("linear_extensions") {
+    call_test_linear_extensions<double>();
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#include "doctest.h"
+#include <iostream>
+#include <vector>
+
+#include "Eigen/Eigen"
+#include <boost/random.hpp>
+
+#include "PackedCSparse/PackedChol.h"
+
+template <int k>
+using CholObj = PackedChol<k, int>;
+
+// A is m x n with columns 0 and 1 equal, so that moving weight from column 0
+// to column 1 leaves A W A' unchanged but passes through an indefinite matrix
+inline SparseMatrix<double, int> packed_chol_test_matrix(int m, int n)
+{
+    boost::mt19937 rng(7);
+    boost::random::uniform_real_distribution<> urdist(-1, 1);
+    boost::random::uniform_int_distribution<> uidist(0, m - 1);
+
+    Eigen::SparseMatrix<double> A(m, n);
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int i = 0; i < m; ++i) triplets.emplace_back(i, 2 + i, 1.0);
+    for (int j = 2 + m; j < n; ++j) {
+        for (int l = 0; l < 3; ++l) triplets.emplace_back(uidist(rng), j, urdist(rng));
+    }
+    triplets.emplace_back(0, 0, 1.0);
+    triplets.emplace_back(3, 0, 0.5);
+    triplets.emplace_back(0, 1, 1.0);
+    triplets.emplace_back(3, 1, 0.5);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    A.makeCompressed();
+
+    SparseMatrix<double, int> out(m, n, A.nonZeros());
+    for (int j = 0; j <= n; ++j) out.p[j] = A.outerIndexPtr()[j];
+    for (int s = 0; s < A.nonZeros(); ++s) {
+        out.i[s] = A.innerIndexPtr()[s];
+        out.x[s] = A.valuePtr()[s];
+    }
+    return out;
+}
+
+template <int k>
+void check_same_factor(CholObj<k> &updated, CholObj<k> &fresh)
+{
+    for (int lane = 0; lane < k; ++lane) {
+        SparseMatrix<double, int> L1 = updated.getL(lane), L2 = fresh.getL(lane);
+        REQUIRE(L1.nnz() == L2.nnz());
+        double err = 0.0, scale = 0.0;
+        for (int s = 0; s < L1.nnz(); ++s) {
+            err = std::max(err, std::abs(L1.x[s] - L2.x[s]));
+            scale = std::max(scale, std::abs(L2.x[s]));
+        }
+        CHECK(err <= 1e-10 * scale);
+    }
+}
+
+void call_test_packed_chol_update()
+{
+    constexpr int k = 2;
+    typedef typename CholObj<k>::Tx2 Tx2;
+    int m = 20, n = 60;
+    SparseMatrix<double, int> A = packed_chol_test_matrix(m, n);
+
+    std::vector<Tx2> w(n);
+    for (int j = 0; j < n; ++j) {
+        set(w[j], 0, 1.0 + 0.01 * j);
+        set(w[j], 1, 2.0 + 0.02 * j);
+    }
+
+    CholObj<k> solver(A);
+    solver.updateThreshold = 5;
+    solver.decompose(w.data());
+
+    std::cout << "--- Testing rank-1 updates of PackedChol" << std::endl;
+    // update in one lane and downdate in the other
+    std::vector<Tx2> w2 = w;
+    set(w2[10], 0, 3.0);
+    set(w2[10], 1, 0.5);
+    set(w2[30], 0, 0.2);
+    set(w2[45], 1, 4.0);
+    solver.updateOrDecompose(w2.data());
+    CHECK(solver.numUpdate == 1);
+    CHECK(solver.numUpdateFallback == 0);
+
+    CholObj<k> fresh(A);
+    fresh.decompose(w2.data());
+    check_same_factor(solver, fresh);
+
+    std::cout << "--- Testing the fallback of PackedChol when a downdate fails" << std::endl;
+    // w_0 + w_1 is unchanged, but the downdate of column 0 comes first and
+    // makes the intermediate matrix indefinite
+    std::vector<Tx2> w3 = w2;
+    for (int lane = 0; lane < k; ++lane) {
+        set(w3[0], lane, get(w2[0], lane) - 10.0);
+        set(w3[1], lane, get(w2[1], lane) + 10.0);
+    }
+    size_t decompositions = solver.numExact[k];
+    solver.updateOrDecompose(w3.data());
+    CHECK(solver.numUpdate == 1);
+    CHECK(solver.numUpdateFallback == 1);
+    CHECK(solver.numExact[k] == decompositions + 1);
+
+    CholObj<k> fresh3(A);
+    fresh3.decompose(w3.data());
+    check_same_factor(solver, fresh3);
+
+    std::cout << "--- Testing PackedChol with more changes than the threshold" << std::endl;
+    std::vector<Tx2> w4 = w3;
+    for (int j = 20; j < 30; ++j) set(w4[j], 0, 5.0);
+    solver.updateOrDecompose(w4.data());
+    CHECK(solver.numUpdate == 1);
+    CHECK(solver.numExact[k] == decompositions + 2);
+}
+
+TEST_CASE("packed_chol_update") {
+    call_test_packed_chol_update();
+}
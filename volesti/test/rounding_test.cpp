@@ -8,6 +8,9 @@
 #include "doctest.h"
 #include <fstream>
 #include <iostream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <boost/random.hpp>
 #include <boost/random/uniform_int.hpp>
@@ -24,6 +27,7 @@
 #include "preprocess/min_sampling_covering_ellipsoid_rounding.hpp"
 #include "preprocess/inscribed_ellipsoid_rounding.hpp"
 #include "preprocess/svd_rounding.hpp"
+#include "preprocess/prepare_polytope.hpp"
 
 #include "generators/known_polytope_generators.h"
 #include "generators/h_polytopes_generator.h"
@@ -293,6 +297,161 @@ void rounding_svd_test(Polytope &HP,
 }
 
 
+template <typename NT>
+void call_test_khachiyan() {
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+
+    // The minimum volume ellipsoid enclosing the vertices of [-1,1]^d is the
+    // ball of radius sqrt(d); the interior points must not change it
+    const int d = 6, num_vertices = 1 << d, num_interior = 500;
+    MT A(d, num_vertices + num_interior);
+    for (int j = 0; j < num_vertices; ++j) {
+        for (int i = 0; i < d; ++i) {
+            A(i, j) = ((j >> i) & 1) ? NT(1) : NT(-1);
+        }
+    }
+    boost::mt19937 gen(42);
+    boost::random::uniform_real_distribution<NT> urdist(-1, 1);
+    for (int j = num_vertices; j < A.cols(); ++j) {
+        for (int i = 0; i < d; ++i) {
+            A(i, j) = urdist(gen);
+        }
+    }
+
+    MT Q(d, d);
+    VT c(d);
+    KhachiyanAlgo(A, 1e-6, 10000, Q, c);
+
+    std::cout << "\n--- Testing Khachiyan algorithm on the vertices of cube6" << std::endl;
+    std::cout << "|dQ - I| = " << (NT(d) * Q - MT::Identity(d, d)).norm()
+              << ", |c| = " << c.norm() << std::endl;
+    CHECK((NT(d) * Q - MT::Identity(d, d)).norm() < 0.01);
+    CHECK(c.norm() < 0.001);
+}
+
+template <typename NT>
+void call_test_max_ellipsoid_sparse_path() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    typedef Eigen::SparseMatrix<NT> SpMT;
+    typedef HPolytope <Point, SpMT> Hpolytope;
+
+    // By default a sparse A takes the same Newton steps as a dense one; with
+    // lumped_newton the interior point method avoids the m x m Newton matrix.
+    // Both have to converge to the same ellipsoid as the dense path
+    std::cout << "\n--- Testing sparse max inscribed ellipsoid of H-skinny_cube10" << std::endl;
+    Hpolytope P = generate_skinny_cube<Hpolytope>(10);
+    SpMT A = P.get_mat();
+    VT b = P.get_vec(), x0 = VT::Zero(P.dimension());
+    JohnEllipsoidParams<NT> params;
+
+    auto [E_dense, c_dense, converged_dense] = max_inscribed_ellipsoid<MT>(MT(A), b, x0, params);
+    auto [E_exact, c_exact, converged_exact] = max_inscribed_ellipsoid<MT>(A, b, x0, params);
+    params.lumped_newton = true;
+    auto [E_sparse, c_sparse, converged_sparse] = max_inscribed_ellipsoid<MT>(A, b, x0, params);
+
+    NT logdet_dense = std::log(E_dense.determinant());
+    NT logdet_exact = std::log(E_exact.determinant());
+    NT logdet_sparse = std::log(E_sparse.determinant());
+    std::cout << "logdet dense = " << logdet_dense << ", logdet sparse = " << logdet_exact
+              << ", logdet lumped = " << logdet_sparse << std::endl;
+    CHECK(converged_dense);
+    CHECK(converged_exact);
+    CHECK(converged_sparse);
+    CHECK(std::abs(logdet_dense - logdet_exact) < 1e-6);
+    CHECK((c_dense - c_exact).norm() < 1e-6);
+    CHECK(std::abs(logdet_dense - logdet_sparse) < 0.01);
+    CHECK((c_dense - c_sparse).norm() < 0.01);
+}
+
+// m random unit rows with nnz non-zeros each and b = 10, plus a box of half-width
+// 10 sqrt(d) so that the polytope is bounded
+template <typename Polytope>
+Polytope sparse_test_hpoly(unsigned int d, unsigned int m, unsigned int nnz, int seed) {
+    typedef typename Polytope::NT NT;
+    typedef typename Polytope::VT VT;
+    typedef typename Polytope::MT MT;
+    typedef Eigen::Triplet<NT> Triplet;
+
+    boost::mt19937 rng(seed);
+    boost::normal_distribution<> rdist(0, 1);
+    boost::random::uniform_int_distribution<unsigned int> uidist(0, d - 1);
+    std::vector<Triplet> triplets;
+    VT b(m + 2 * d);
+
+    for (unsigned int i = 0; i < m; ++i) {
+        std::vector<unsigned int> cols;
+        while (cols.size() < nnz) {
+            unsigned int col = uidist(rng);
+            if (std::find(cols.begin(), cols.end(), col) == cols.end()) cols.push_back(col);
+        }
+        VT row(nnz);
+        for (unsigned int k = 0; k < nnz; ++k) row(k) = rdist(rng);
+        row.normalize();
+        for (unsigned int k = 0; k < nnz; ++k) triplets.push_back(Triplet(i, cols[k], row(k)));
+        b(i) = NT(10);
+    }
+    for (unsigned int j = 0; j < d; ++j) {
+        triplets.push_back(Triplet(m + 2 * j, j, NT(1)));
+        triplets.push_back(Triplet(m + 2 * j + 1, j, NT(-1)));
+        b(m + 2 * j) = b(m + 2 * j + 1) = NT(10) * std::sqrt(NT(d));
+    }
+
+    MT A(m + 2 * d, d);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    return Polytope(d, A, b);
+}
+
+template <typename NT>
+void call_test_max_ellipsoid_sketch() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, Eigen::Dynamic> MT;
+    typedef Eigen::Matrix<NT, Eigen::Dynamic, 1> VT;
+    typedef Eigen::SparseMatrix<NT> SpMT;
+    typedef HPolytope <Point, SpMT> Hpolytope;
+
+    std::cout << "\n--- Testing the sketched diagonal of A H^{-1} A^T" << std::endl;
+    unsigned int d = 20, m = 400;
+    Hpolytope P = sparse_test_hpoly<Hpolytope>(d, m, 3, 127);
+    SpMT A = P.get_mat(), A_trans = A.transpose();
+    SpMT H = A_trans * A;
+    VT diag_exact, diag_sketch;
+    NT logdet_exact, logdet_sketch;
+
+    auto llt = initialize_chol<NT>(A_trans, A);
+    solve_diag(llt, H, A_trans, diag_exact, logdet_exact);
+    sketch_diag(llt, H, A, 2000, diag_sketch, logdet_sketch);
+
+    // with k projections the relative error of each entry has standard deviation sqrt(2 / k)
+    VT rel_err = (diag_sketch - diag_exact).cwiseQuotient(diag_exact);
+    std::cout << "max relative error = " << rel_err.cwiseAbs().maxCoeff()
+              << ", mean relative error = " << rel_err.mean() << std::endl;
+    CHECK(logdet_sketch == logdet_exact);
+    CHECK(rel_err.cwiseAbs().maxCoeff() < 0.25);
+    CHECK(std::abs(rel_err.mean()) < 0.05);
+
+    std::cout << "\n--- Testing sparse max inscribed ellipsoid with a sketched diagonal" << std::endl;
+    VT b = P.get_vec(), x0 = VT::Zero(d);
+    JohnEllipsoidParams<NT> params;
+    params.lumped_newton = true;
+    auto [E_lumped, c_lumped, converged_lumped] = max_inscribed_ellipsoid<MT>(A, b, x0, params);
+    params.diag_sketch_size = 100;
+    auto [E_sketch, c_sketch, converged_sketch] = max_inscribed_ellipsoid<MT>(A, b, x0, params);
+
+    NT logdet_lumped = std::log(E_lumped.determinant());
+    logdet_sketch = std::log(E_sketch.determinant());
+    std::cout << "logdet lumped = " << logdet_lumped << ", logdet sketched = " << logdet_sketch << std::endl;
+    CHECK(converged_lumped);
+    CHECK(converged_sketch);
+    // the sketched ellipsoid may overshoot the facets, by a few percent per axis
+    CHECK(std::abs(logdet_lumped - logdet_sketch) < 0.1 * d);
+    CHECK(P.is_in(Point(c_sketch)) == -1);
+}
+
 template <typename NT>
 void call_test_min_ellipsoid() {
     typedef Cartesian <NT> Kernel;
@@ -381,6 +540,143 @@ void call_test_svd() {
     rounding_svd_test(P, 0, 3070.64, 3188.25, 3140.6, 3200.0);
 }
 
+template <typename NT>
+void call_test_prepare_polytope() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef HPolytope <Point> Hpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef typename Hpolytope::VT VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 5> RNGType;
+
+    std::cout << "\n--- Testing preparation of H-skinny_cube5" << std::endl;
+    Hpolytope P = generate_skinny_cube<Hpolytope>(5);
+    int d = P.dimension();
+    RNGType rng(d);
+
+    PreparedPolytope<MT, VT, Point> prep =
+        prepare_polytope<CDHRWalk, MT, VT>(P, rng, MAX_INSCRIBED_ELLIPSOID_ROUNDING);
+    prep.print_preparation_time(std::cout);
+
+    // the inner ball of the rounded body must match a cold computation
+    Hpolytope Q(d, P.get_mat(), P.get_vec());
+    std::pair<Point, NT> cold_ball = Q.ComputeInnerBall();
+    CHECK(std::abs(prep.inner_ball.second - cold_ball.second) < 1e-4 * cold_ball.second);
+    CHECK(prep.diameter == compute_diameter<Hpolytope>::template compute<NT>(P));
+
+    // round trip through a stream
+    std::stringstream ss;
+    write_prepared_polytope(ss, P, prep);
+    Hpolytope P2;
+    PreparedPolytope<MT, VT, Point> prep2;
+    CHECK(read_prepared_polytope(ss, P2, prep2));
+    CHECK((P2.get_mat() - P.get_mat()).norm() < 1e-12);
+    CHECK((P2.get_vec() - P.get_vec()).norm() < 1e-12);
+    CHECK((prep2.T - prep.T).norm() == 0);
+    CHECK(prep2.round_val == prep.round_val);
+    CHECK(prep2.inner_ball.second == prep.inner_ball.second);
+
+    NT volume = prep2.round_val * volume_cooling_balls<BilliardWalk, RNGType>(P2, 0.1, 1).second;
+    test_values(volume, NT(3262.61), NT(3200.0));
+}
+
+template <typename NT>
+void call_test_prepared_round_trip() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef HPolytope <Point> Hpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef typename Hpolytope::VT VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 5> RNGType;
+
+    std::cout << "\n--- Testing the round trip of a prepared H-skinny_cube5" << std::endl;
+    Hpolytope P = generate_skinny_cube<Hpolytope>(5);
+    RNGType rng(P.dimension());
+    PreparedPolytope<MT, VT, Point> prep =
+        prepare_polytope<CDHRWalk, MT, VT>(P, rng, MAX_INSCRIBED_ELLIPSOID_ROUNDING);
+
+    std::stringstream ss;
+    write_prepared_polytope(ss, P, prep);
+    Hpolytope P2;
+    PreparedPolytope<MT, VT, Point> prep2;
+    CHECK(read_prepared_polytope(ss, P2, prep2));
+
+    // the stored state is restored as written
+    CHECK(P2.is_normalized() == P.is_normalized());
+    CHECK(P2.get_mat() == P.get_mat());
+    CHECK(P2.get_vec() == P.get_vec());
+    CHECK(prep2.T == prep.T);
+    CHECK(prep2.shift == prep.shift);
+    CHECK(prep2.round_val == prep.round_val);
+    CHECK(prep2.diameter == prep.diameter);
+    CHECK(prep2.inner_ball.first.getCoefficients() == prep.inner_ball.first.getCoefficients());
+    CHECK(prep2.inner_ball.second == prep.inner_ball.second);
+
+    // normalizing the restored polytope again does not change it
+    P2.normalize();
+    CHECK(P2.get_mat() == P.get_mat());
+
+    std::stringstream ss2;
+    write_prepared_polytope(ss2, P2, prep2);
+    CHECK(ss2.str() == ss.str());
+}
+
+template <typename NT>
+void call_test_prepare_polytopes() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef HPolytope <Point> Hpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef typename Hpolytope::VT VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT> RNGType;
+
+    std::cout << "\n--- Testing the preparation of several polytopes" << std::endl;
+    std::vector<Hpolytope> bodies{generate_skinny_cube<Hpolytope>(5),
+                                  generate_cube<Hpolytope>(4, false),
+                                  generate_cross<Hpolytope>(4, false)};
+    unsigned int seed = 7;
+
+    // body i must be prepared as if alone, with a generator seeded with seed + i
+    std::vector<Hpolytope> expected_bodies = bodies;
+    std::vector<PreparedPolytope<MT, VT, Point>> expected;
+    for (unsigned int i = 0; i < bodies.size(); i++)
+    {
+        RNGType rng(bodies[i].dimension());
+        rng.set_seed(seed + i);
+        expected.push_back(prepare_polytope<CDHRWalk, MT, VT>(expected_bodies[i], rng, SVD_ROUNDING));
+    }
+
+    std::vector<int> thread_counts{1};
+#ifdef _OPENMP
+    int max_threads = omp_get_max_threads();
+    thread_counts = {1, 2, 4};
+#endif
+    for (int num_threads : thread_counts)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#endif
+        std::vector<Hpolytope> prepared_bodies = bodies;
+        std::vector<PreparedPolytope<MT, VT, Point>> prepared =
+            prepare_polytopes<CDHRWalk, MT, VT, RNGType>(prepared_bodies, seed, SVD_ROUNDING);
+
+        CHECK(prepared.size() == bodies.size());
+        for (unsigned int i = 0; i < bodies.size(); i++)
+        {
+            CHECK(prepared_bodies[i].get_mat() == expected_bodies[i].get_mat());
+            CHECK(prepared_bodies[i].get_vec() == expected_bodies[i].get_vec());
+            CHECK(prepared[i].T == expected[i].T);
+            CHECK(prepared[i].shift == expected[i].shift);
+            CHECK(prepared[i].round_val == expected[i].round_val);
+            CHECK(prepared[i].diameter == expected[i].diameter);
+            CHECK(prepared[i].inner_ball.second == expected[i].inner_ball.second);
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+}
+
 template <typename NT>
 void call_test_sparse() {
     typedef Cartesian <NT> Kernel;
@@ -415,6 +711,10 @@ void call_test_sparse() {
 
 
 
+TEST_CASE("khachiyan") {
+    call_test_khachiyan<double>();
+}
+
 TEST_CASE("round_min_ellipsoid") {
     call_test_min_ellipsoid<double>();
 }
@@ -423,6 +723,14 @@ TEST_CASE("round_max_ellipsoid") {
     call_test_max_ellipsoid<double>();
 }
 
+TEST_CASE("max_ellipsoid_sparse_path") {
+    call_test_max_ellipsoid_sparse_path<double>();
+}
+
+TEST_CASE("max_ellipsoid_sketch") {
+    call_test_max_ellipsoid_sketch<double>();
+}
+
 TEST_CASE("round_max_ellipsoid_sparse") {
     call_test_max_ellipsoid_sparse<double>();
 }
@@ -443,6 +751,18 @@ TEST_CASE("round_svd") {
     call_test_svd<double>();
 }
 
+TEST_CASE("prepare_polytope") {
+    call_test_prepare_polytope<double>();
+}
+
+TEST_CASE("prepared_round_trip") {
+    call_test_prepared_round_trip<double>();
+}
+
+TEST_CASE("prepare_polytopes") {
+    call_test_prepare_polytopes<double>();
+}
+
 TEST_CASE("round_sparse") {
     call_test_sparse<double>();
 }
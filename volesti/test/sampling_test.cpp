@@ -19,11 +19,16 @@
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "misc/misc.h"
 #include "random_walks/random_walks.hpp"
 
 #include "volume/volume_sequence_of_balls.hpp"
 #include "generators/known_polytope_generators.h"
+#include "generators/h_polytopes_generator.h"
 #include "sampling/sampling.hpp"
 
 #include "diagnostics/univariate_psrf.hpp"
@@ -461,6 +466,265 @@ void call_test_sparse(){
     CHECK(score.maxCoeff() < 1.1);
 }
 
+template <typename NT>
+void call_test_facet_index(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    unsigned int d = 10, m = 500;
+
+    std::cout << "--- Testing facet neighborhood index for random H-polytope" << std::endl;
+    Hpolytope P = random_hpoly<Hpolytope, boost::mt19937>(d, m, 127);
+    Hpolytope P_index = P;
+    P_index.set_facet_index(4 * d);
+    RNGType rng(d);
+
+    VT Ar(m), Av(m), Ar_index(m), Av_index(m);
+    Point p(d), v = GetDirection<Point>::apply(d, rng);
+    for (int i = 0; i < 1000; ++i) {
+        auto hit = P.line_positive_intersect(p, v, Ar, Av);
+        auto hit_index = P_index.line_positive_intersect(p, v, Ar_index, Av_index);
+        CHECK(hit.second == hit_index.second);
+        CHECK(std::abs(hit.first - hit_index.first) <= 1e-10 * hit.first);
+
+        p += (0.995 * hit.first * rng.sample_urdist()) * v;
+        if (rng.sample_urdist() < 0.5) {
+            P.compute_reflection(v, p, hit.second);
+        } else {
+            v = GetDirection<Point>::apply(d, rng);
+        }
+    }
+    CHECK(P_index.num_facet_index_hits > 0);
+
+    NT omega = std::sqrt(NT(2) * NT(0.5));
+    int facet_prev = -1, facet_prev_index = -1;
+    p = Point(d);
+    for (int i = 0; i < 1000; ++i) {
+        v = GetDirection<Point>::apply(d, rng, false);
+        auto hit = P.trigonometric_positive_intersect(p, v, omega, facet_prev);
+        auto hit_index = P_index.trigonometric_positive_intersect(p, v, omega, facet_prev_index);
+        CHECK(hit.second == hit_index.second);
+        CHECK(std::abs(hit.first - hit_index.first) <= 1e-10 * hit.first);
+
+        NT t = 0.995 * hit.first * rng.sample_urdist();
+        p = Point(std::cos(omega * t) * p.getCoefficients() + (std::sin(omega * t) / omega) * v.getCoefficients());
+        facet_prev = facet_prev_index = -1;
+    }
+}
+
+template <typename NT>
+void call_test_trigonometric_oracle(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    unsigned int d = 10, m = 1000;
+
+    // the cube [0,2]^d has facets with b_i = 0 and [1,3]^d has facets with b_i < 0
+    std::vector<Hpolytope> polytopes;
+    polytopes.push_back(random_hpoly<Hpolytope, boost::mt19937>(d, m, 127));
+    for (NT lo : {NT(0), NT(1)}) {
+        MT A = MT::Zero(200, d);
+        VT b(200);
+        for (unsigned int i = 0; i < 100; ++i) {
+            A(i, i % d) = 1;
+            A(100 + i, i % d) = -1;
+            b(i) = lo + 2;
+            b(100 + i) = -lo;
+        }
+        polytopes.push_back(Hpolytope(d, A, b));
+    }
+
+    std::cout << "--- Testing the vectorized trigonometric oracle against the scalar one" << std::endl;
+    RNGType rng(d);
+    for (Hpolytope& P : polytopes) {
+        Hpolytope P_scalar = P;
+        P_scalar.set_vectorized_trigonometric_oracle(false);
+        VT center = VT::Zero(d);
+        if (P.num_of_hyperplanes() == 200) center = VT::Constant(d, P.get_vec()(0) - NT(1));
+
+        // from almost a point mass (few facets can be hit) to a wide gaussian (most can)
+        for (NT omega : {NT(10), NT(1), NT(0.1), NT(0.01)}) {
+            int facet_prev = -1, facet_prev_scalar = -1;
+            Point p(center);
+            for (int i = 0; i < 200; ++i) {
+                Point v = GetDirection<Point>::apply(d, rng, false);
+                auto hit = P.trigonometric_positive_intersect(p, v, omega, facet_prev);
+                auto hit_scalar = P_scalar.trigonometric_positive_intersect(p, v, omega, facet_prev_scalar);
+                CHECK(hit.second == hit_scalar.second);
+                CHECK(hit.first == hit_scalar.first);
+                if (hit.second < 0) continue;
+
+                // move to the boundary and keep the previous facet, as the exact hmc walk does
+                NT t = (i % 2 == 0) ? hit.first : NT(0.9) * hit.first;
+                p = Point(std::cos(omega * t) * p.getCoefficients()
+                          + (std::sin(omega * t) / omega) * v.getCoefficients());
+                if (i % 2 != 0) facet_prev = facet_prev_scalar = -1;
+            }
+        }
+    }
+}
+
+template <typename NT>
+void call_test_coordinate_index(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef HPolytope<Point, Eigen::SparseMatrix<NT, Eigen::RowMajor>> SparseHpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,1> VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    unsigned int d = 30, m = 3 * d;
+
+    std::cout << "--- Testing sparse coordinate oracles for a banded H-polytope" << std::endl;
+    // the cube [-1,1]^d cut by the band constraints x_i - x_{i+1} <= 1.5
+    MT A = MT::Zero(m, d);
+    VT b = VT::Ones(m);
+    for (unsigned int i = 0; i < d; ++i) {
+        A(i, i) = 1;
+        A(d + i, i) = -1;
+        A(2 * d + i, i) = 1;
+        A(2 * d + i, (i + 1) % d) = -1;
+        b(2 * d + i) = 1.5;
+    }
+    Hpolytope P(d, A, b);
+    SparseHpolytope SP(d, A, b);
+    RNGType rng(d);
+
+    // reference chord computed from all the rows of A
+    auto chord = [&](Point const& r, unsigned int coord) {
+        VT slack = b - A * r.getCoefficients();
+        NT min_plus = std::numeric_limits<NT>::max();
+        NT max_minus = std::numeric_limits<NT>::lowest();
+        for (unsigned int i = 0; i < m; ++i) {
+            if (A(i, coord) == NT(0)) continue;
+            NT lamda = slack(i) / A(i, coord);
+            if (lamda < min_plus && lamda > 0) min_plus = lamda;
+            if (lamda > max_minus && lamda < 0) max_minus = lamda;
+        }
+        return std::make_pair(min_plus, max_minus);
+    };
+
+    Point p(d), p_prev(d);
+    VT lamdas(m), lamdas_sparse(m);
+    unsigned int coord = rng.sample_uidist(), coord_prev;
+    auto bpair = P.line_intersect_coord(p, coord, lamdas);
+    auto bpair_sparse = SP.line_intersect_coord(p, coord, lamdas_sparse);
+    auto ref = chord(p, coord);
+    CHECK(bpair.first == ref.first);
+    CHECK(bpair.second == ref.second);
+    CHECK(bpair_sparse.first == ref.first);
+    CHECK(bpair_sparse.second == ref.second);
+
+    for (int i = 0; i < 1000; ++i) {
+        p_prev = p;
+        p.set_coord(coord, p[coord] + bpair.first + rng.sample_urdist() * (bpair.second - bpair.first));
+        coord_prev = coord;
+        coord = rng.sample_uidist();
+
+        bpair = P.line_intersect_coord(p, p_prev, coord, coord_prev, lamdas);
+        bpair_sparse = SP.line_intersect_coord(p, p_prev, coord, coord_prev, lamdas_sparse);
+        ref = chord(p, coord);
+        CHECK(std::abs(bpair.first - ref.first) < 1e-10);
+        CHECK(std::abs(bpair.second - ref.second) < 1e-10);
+        CHECK(std::abs(bpair_sparse.first - ref.first) < 1e-10);
+        CHECK(std::abs(bpair_sparse.second - ref.second) < 1e-10);
+        CHECK((lamdas - (b - A * p.getCoefficients())).norm() < 1e-10);
+    }
+}
+
+template <typename NT>
+void call_test_diameter(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef Eigen::Matrix<NT,Eigen::Dynamic,Eigen::Dynamic> MT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    unsigned int d = 10, k = 300;
+    RNGType rng(d);
+
+    std::cout << "--- Testing the diameter of a point set" << std::endl;
+    MT V(k, d);
+    for (unsigned int i = 0; i < k; ++i) {
+        for (unsigned int j = 0; j < d; ++j) {
+            V(i, j) = rng.sample_urdist() * NT(j + 1);
+        }
+    }
+    NT exact = NT(0);
+    for (unsigned int i = 0; i < k; ++i) {
+        for (unsigned int j = i + 1; j < k; ++j) {
+            exact = std::max(exact, (V.row(i) - V.row(j)).norm());
+        }
+    }
+    CHECK(std::abs(point_set_diameter<NT>(V) - exact) < 1e-10 * exact);
+    // without time the method returns an upper bound
+    CHECK(point_set_diameter<NT>(V, 0.0) >= exact);
+
+    std::cout << "--- Testing the online update of L in accelerated billiard walk" << std::endl;
+    Hpolytope P = generate_skinny_cube<Hpolytope>(d);
+    NT diameter = std::sqrt(NT(4 * (d - 1)) + NT(200 * 200));
+    Point p = P.ComputeInnerBall().first;
+    AcceleratedBilliardWalk::Walk<Hpolytope, RNGType>
+        walk(P, p, rng, AcceleratedBilliardWalk(0.1, true, true).param);
+    walk.apply(P, p, 100, rng);
+    CHECK(walk.get_delta() > 0.1);
+    CHECK(walk.get_delta() == walk.get_max_chord());
+    CHECK(walk.get_delta() <= diameter);
+}
+
+template <typename NT>
+void call_test_generators(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef HPolytope<Point, Eigen::SparseMatrix<NT, Eigen::RowMajor>> SparseHpolytope;
+    typedef typename SparseHpolytope::MT SparseMT;
+    unsigned int d = 20, m = 100, nnz = 4;
+
+    std::cout << "--- Testing parallel generation of random H-polytopes" << std::endl;
+    Hpolytope P1 = random_hpoly<Hpolytope, boost::mt19937>(d, m, 127, true);
+    Hpolytope P2 = random_hpoly<Hpolytope, boost::mt19937>(d, m, 127, true);
+    CHECK(P1.get_mat() == P2.get_mat());
+    CHECK((P1.get_mat().rowwise().norm().array() - NT(1)).abs().maxCoeff() < 1e-12);
+
+    SparseHpolytope SP = random_sparse_hpoly<SparseHpolytope, boost::mt19937>(d, m, nnz, 127);
+    SparseMT const& A = SP.get_mat();
+    CHECK(A.rows() == m + 2 * d);
+    for (unsigned int i = 0; i < m; ++i) {
+        CHECK(A.row(i).nonZeros() == nnz);
+        CHECK(std::abs(A.row(i).norm() - NT(1)) < 1e-12);
+    }
+    CHECK(SP.ComputeInnerBall().second > NT(0));
+
+    Hpolytope SK1 = skinny_random_hpoly<Hpolytope, NT, boost::mt19937>(d, m, false, NT(100), 127, true);
+    Hpolytope SK2 = skinny_random_hpoly<Hpolytope, NT, boost::mt19937>(d, m, false, NT(100), 127, true);
+    CHECK(SK1.get_mat() == SK2.get_mat());
+
+#ifdef _OPENMP
+    std::cout << "--- Testing that the generated H-polytopes do not depend on the number of threads" << std::endl;
+    int max_threads = omp_get_max_threads();
+    // SP has been normalized by ComputeInnerBall, so compare with a fresh copy
+    SparseHpolytope SP1 = random_sparse_hpoly<SparseHpolytope, boost::mt19937>(d, m, nnz, 127);
+    for (int num_threads : {1, 2, 4}) {
+        omp_set_num_threads(num_threads);
+        Hpolytope Q = random_hpoly<Hpolytope, boost::mt19937>(d, m, 127, true);
+        SparseHpolytope SQ = random_sparse_hpoly<SparseHpolytope, boost::mt19937>(d, m, nnz, 127);
+        Hpolytope SKQ = skinny_random_hpoly<Hpolytope, NT, boost::mt19937>(d, m, false, NT(100), 127, true);
+        CHECK(Q.get_mat() == P1.get_mat());
+        CHECK(Q.get_vec() == P1.get_vec());
+        CHECK((SparseMT(SQ.get_mat()) - SP1.get_mat()).norm() == NT(0));
+        CHECK(SQ.get_vec() == SP1.get_vec());
+        CHECK(SKQ.get_mat() == SK1.get_mat());
+        CHECK(SKQ.get_vec() == SK1.get_vec());
+    }
+    omp_set_num_threads(max_threads);
+#endif
+}
+
 TEST_CASE("dikin") {
     call_test_dikin<double>();
 }
@@ -500,3 +764,23 @@ TEST_CASE("gabw") {
 TEST_CASE("sparse") {
     call_test_sparse<double>();
 }
+
+TEST_CASE("coordinate_index") {
+    call_test_coordinate_index<double>();
+}
+
+TEST_CASE("facet_index") {
+    call_test_facet_index<double>();
+}
+
+TEST_CASE("trigonometric_oracle") {
+    call_test_trigonometric_oracle<double>();
+}
+
+TEST_CASE("diameter") {
+    call_test_diameter<double>();
+}
+
+TEST_CASE("generators") {
+    call_test_generators<double>();
+}
@@ -0,0 +1,242 @@
+// VolEsti (volume computation and sampling library)
+
+// Copyright (c) 2012-2024 Vissarion Fisikopoulos
+// Copyright (c) 2018-2024 Apostolos Chalkis
+
+// Licensed under GNU LGPL.3, see LICENCE file
+
+#include "doctest.h"
+#include <iostream>
+#include <vector>
+
+#include "Eigen/Eigen"
+#include <boost/random.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "random_walks/random_walks.hpp"
+#include "volume/volume_cooling_balls.hpp"
+#include "matrix_operations/EigenvaluesProblems.h"
+#include "convex_bodies/spectrahedra/spectrahedron.h"
+#include "convex_bodies/spectrahedra/block_spectrahedron.h"
+
+
+// The LMI A_0 + \sum x_i A_i with A_0 = -I and random symmetric A_i,
+// so that the origin is an interior point
+template <typename NT, typename MT>
+std::vector<MT> random_lmi_matrices(int d, int m, unsigned int seed)
+{
+    boost::mt19937 rng(seed);
+    boost::normal_distribution<> rdist(0, 1);
+
+    std::vector<MT> matrices;
+    matrices.push_back(-MT::Identity(m, m));
+    for (int i = 0; i < d; i++) {
+        MT A(m, m);
+        for (int r = 0; r < m; r++) {
+            for (int c = 0; c <= r; c++) {
+                A(r, c) = A(c, r) = rdist(rng) / std::sqrt(NT(m));
+            }
+        }
+        matrices.push_back(A);
+    }
+    return matrices;
+}
+
+// The unit disk as the 2x2 LMI [-1 + x_1, x_2; x_2, -1 - x_1] <= 0
+template <typename NT, typename MT>
+std::vector<MT> disk_lmi_matrices()
+{
+    MT A0 = -MT::Identity(2, 2), A1(2, 2), A2(2, 2);
+    A1 << 1, 0, 0, -1;
+    A2 << 0, 1, 1, 0;
+    return std::vector<MT>{A0, A1, A2};
+}
+
+// A block diagonal LMI in 4 variables: block_matrices[i][j] is the j-th block of A_i.
+// The blocks have sizes 1, 4, 2 and 35, so that every block oracle is exercised
+// (closed form, dense eigensolver and Spectra); the 2x2 block does not depend on x
+template <typename NT, typename MT>
+std::vector<std::vector<MT>> random_block_lmi_matrices(unsigned int seed)
+{
+    int const d = 4;
+    std::vector<int> sizes = {1, 4, 2, 35};
+    // the variables that appear in each block
+    std::vector<std::vector<int>> vars = {{0}, {0, 1, 2}, {}, {0, 1, 2, 3}};
+
+    boost::mt19937 rng(seed);
+    boost::normal_distribution<> rdist(0, 1);
+
+    std::vector<std::vector<MT>> block_matrices(d + 1);
+    for (int j = 0; j < sizes.size(); j++) {
+        int m = sizes[j];
+        block_matrices[0].push_back(-MT::Identity(m, m));
+        for (int i = 1; i <= d; i++) {
+            MT A = MT::Zero(m, m);
+            if (std::find(vars[j].begin(), vars[j].end(), i - 1) != vars[j].end()) {
+                for (int r = 0; r < m; r++) {
+                    for (int c = 0; c <= r; c++) {
+                        A(r, c) = A(c, r) = rdist(rng) / std::sqrt(NT(m));
+                    }
+                }
+            }
+            block_matrices[i].push_back(A);
+        }
+    }
+    return block_matrices;
+}
+
+// Places the blocks of every A_i on the diagonal
+template <typename MT>
+std::vector<MT> block_diagonal_matrices(std::vector<std::vector<MT>> const& block_matrices)
+{
+    int m = 0;
+    for (auto const& block : block_matrices[0]) m += block.rows();
+
+    std::vector<MT> matrices;
+    for (auto const& blocks : block_matrices) {
+        MT A = MT::Zero(m, m);
+        int offset = 0;
+        for (auto const& block : blocks) {
+            A.block(offset, offset, block.rows(), block.cols()) = block;
+            offset += block.rows();
+        }
+        matrices.push_back(A);
+    }
+    return matrices;
+}
+
+template <typename NT>
+void call_test_warm_start_oracle()
+{
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef Spectrahedron<Point> SPECTRAHEDRON;
+    typedef typename SPECTRAHEDRON::MT MT;
+    typedef typename SPECTRAHEDRON::VT VT;
+    typedef LMI<NT, MT, VT> LMI_TYPE;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+
+    std::cout << "--- Testing the warm-started spectrahedron oracle along a billiard trajectory" << std::endl;
+    unsigned int d = 5;
+    std::vector<MT> matrices = random_lmi_matrices<NT, MT>(d, 40, 5);
+    SPECTRAHEDRON P_warm((LMI_TYPE(matrices)));
+    SPECTRAHEDRON P_cold = P_warm;
+    P_warm.set_warm_start_oracle(true);
+
+    RNGType rng(d);
+    Point p(d);
+    Point v = GetDirection<Point>::apply(d, rng);
+    unsigned int num_steps = 50;
+    for (unsigned int i = 0; i < num_steps; i++) {
+        P_warm.resetFlags();
+        P_cold.resetFlags();
+        NT lambda_warm = P_warm.line_positive_intersect(p, v).first;
+        NT lambda_cold = P_cold.line_positive_intersect(p, v).first;
+        CHECK(std::abs(lambda_warm - lambda_cold) <= 1e-08 * lambda_cold);
+
+        p += (NT(0.9) * lambda_cold) * v;
+        CHECK(P_cold.is_in(p) == -1);
+        P_warm.compute_reflection(v, p);
+    }
+    CHECK(P_warm.num_warm_start_calls == num_steps);
+
+    std::cout << "--- Testing the warm-started spectrahedron oracle on a 2x2 LMI" << std::endl;
+    std::vector<MT> disk_matrices = disk_lmi_matrices<NT, MT>();
+    SPECTRAHEDRON disk((LMI_TYPE(disk_matrices)));
+    disk.set_warm_start_oracle(true);
+
+    VT x = VT::Zero(2), u(2);
+    u << 0.6, 0.8;
+    disk.resetFlags();
+    CHECK(disk.line_positive_intersect(Point(x), Point(u)).first == doctest::Approx(1.0));
+
+    x << 0.5, 0;
+    u << 1, 0;
+    disk.resetFlags();
+    CHECK(disk.line_positive_intersect(Point(x), Point(u)).first == doctest::Approx(0.5));
+    disk.resetFlags();
+    CHECK(disk.line_positive_intersect(Point(x), Point(VT(-u))).first == doctest::Approx(1.5));
+}
+
+template <typename NT>
+void call_test_block_spectrahedron()
+{
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef Spectrahedron<Point> SPECTRAHEDRON;
+    typedef BlockSpectrahedron<Point> BLOCK_SPECTRAHEDRON;
+    typedef typename SPECTRAHEDRON::MT MT;
+    typedef typename SPECTRAHEDRON::VT VT;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+
+    std::vector<std::vector<MT>> block_matrices = random_block_lmi_matrices<NT, MT>(7);
+    std::vector<MT> matrices = block_diagonal_matrices(block_matrices);
+    BLOCK_SPECTRAHEDRON B((BlockLMI<NT, MT, VT>(block_matrices)));
+    SPECTRAHEDRON S((LMI<NT, MT, VT>(matrices)));
+    unsigned int d = B.dimension();
+
+    CHECK(B.getLMI().numBlocks() == 3);
+    CHECK(B.getLMI().sizeOfMatrices() == 40);
+
+    std::cout << "--- Testing membership of a block spectrahedron" << std::endl;
+    RNGType rng(d);
+    unsigned int num_inside = 0;
+    for (int i = 0; i < 200; i++) {
+        VT x(d);
+        for (unsigned int k = 0; k < d; k++) x(k) = rng.sample_urdist() - 0.5;
+        Point p(x);
+        CHECK(B.is_in(p) == S.is_in(p));
+        if (B.is_in(p) == -1) num_inside++;
+    }
+    CHECK(num_inside > 0);
+    CHECK(num_inside < 200);
+
+    std::cout << "--- Testing line intersections and reflections of a block spectrahedron" << std::endl;
+    Point p(d);
+    for (int i = 0; i < 50; i++) {
+        Point v = GetDirection<Point>::apply(d, rng);
+
+        std::pair<NT, NT> b_inter = B.line_intersect(p, v);
+        std::pair<NT, NT> s_inter = S.line_intersect(p, v);
+        CHECK(b_inter.first == doctest::Approx(s_inter.first).epsilon(1e-08));
+        CHECK(b_inter.second == doctest::Approx(s_inter.second).epsilon(1e-08));
+
+        B.resetFlags();
+        S.resetFlags();
+        NT lambda = B.line_positive_intersect(p, v).first;
+        CHECK(lambda == doctest::Approx(S.line_positive_intersect(p, v).first).epsilon(1e-08));
+
+        Point q = p + lambda * v;
+        Point b_v = v, s_v = v;
+        B.compute_reflection(b_v, q);
+        S.compute_reflection(s_v, q);
+        CHECK((b_v.getCoefficients() - s_v.getCoefficients()).norm() <= 1e-06);
+
+        // continue from an interior point along the reflected direction
+        p = p + (NT(0.5) * lambda) * v;
+        CHECK(S.is_in(p) == -1);
+    }
+
+    // no block is hit along an unbounded ray, so there is nothing to reflect on
+    BLOCK_SPECTRAHEDRON B_fresh((BlockLMI<NT, MT, VT>(block_matrices)));
+    Point v = GetDirection<Point>::apply(d, rng), v_copy = v;
+    B_fresh.compute_reflection(v, Point(d));
+    CHECK((v.getCoefficients() - v_copy.getCoefficients()).norm() == 0);
+
+    std::cout << "--- Testing volume of a block spectrahedron" << std::endl;
+    Point interior_point(d);
+    NT b_volume = volume_cooling_balls<BilliardWalk, RNGType>(B, interior_point, 1, 0.1).second;
+    NT s_volume = volume_cooling_balls<BilliardWalk, RNGType>(S, interior_point, 1, 0.1).second;
+    std::cout << "Computed volumes: block = " << b_volume << ", dense = " << s_volume << std::endl;
+    CHECK(std::abs(b_volume - s_volume) / s_volume < 0.2);
+}
+
+TEST_CASE("spectrahedron_warm_start_oracle") {
+    call_test_warm_start_oracle<double>();
+}
+
+TEST_CASE("block_spectrahedron") {
+    call_test_block_spectrahedron<double>();
+}
@@ -89,6 +89,57 @@ void call_test_max_ball_sparse() {
     CHECK(converged);
 }
 
+template <typename NT>
+void call_test_max_ball_warm_start() {
+    typedef Cartesian <NT> Kernel;
+    typedef typename Kernel::Point Point;
+    typedef HPolytope <Point> Hpolytope;
+    typedef typename Hpolytope::MT MT;
+    typedef typename Hpolytope::VT VT;
+    typedef boost::mt19937 PolyRNGType;
+    Hpolytope P;
+
+    std::cout << "\n--- Testing warm started Chebychev ball for skinny H-polytope" << std::endl;
+    bool pre_rounding = true; // round random polytope before applying the skinny transformation
+    NT max_min_eig_ratio = NT(2000);
+    P = skinny_random_hpoly<Hpolytope, NT, PolyRNGType>(10, 200, pre_rounding, max_min_eig_ratio, 127);
+    P.normalize();
+    MT A = P.get_mat();
+    VT b = P.get_vec();
+
+    NT tol = 1e-08;
+    unsigned int maxiter = 500;
+    InscribedBallWarmStart<MT, VT, NT> warm_start;
+    max_inscribed_ball(A, b, maxiter, tol, warm_start);
+    unsigned int cold_iterations = warm_start.iterations;
+
+    // shift b
+    for (int i = 0; i < b.size(); i++) {
+        b(i) += NT(0.005) * std::abs(b(i)) * ((i % 3) - NT(1));
+    }
+    NT radius = ComputeChebychevBall<NT, Point>(A, b).second; // use lpsolve library
+    auto [center_w, radius_w, converged_w] = max_inscribed_ball(A, b, maxiter, tol, warm_start);
+    std::cout << "cold iterations: " << cold_iterations
+              << ", warm iterations after shifting b: " << warm_start.iterations << std::endl;
+    CHECK(converged_w);
+    CHECK(std::abs(radius - radius_w) <= 1e-06 * radius);
+    CHECK(warm_start.iterations < cold_iterations);
+
+    // add a constraint that cuts through the previous ball
+    MT A2(A.rows() + 1, A.cols());
+    VT b2(b.size() + 1), a = VT::Ones(A.cols()).normalized(), dual2(b.size() + 1);
+    A2 << A, a.transpose();
+    b2 << b, a.dot(center_w) + radius_w / NT(2);
+    dual2 << warm_start.dual, NT(0);
+    warm_start.dual = dual2;
+    radius = ComputeChebychevBall<NT, Point>(A2, b2).second;
+    std::tie(center_w, radius_w, converged_w) = max_inscribed_ball(A2, b2, maxiter, tol, warm_start);
+    std::cout << "warm iterations after adding a constraint: " << warm_start.iterations << std::endl;
+    CHECK(converged_w);
+    CHECK(std::abs(radius - radius_w) <= 1e-06 * radius);
+    CHECK((A2 * center_w - b2).maxCoeff() < 0);
+}
+
 template <typename NT>
 void call_test_max_ball_feasibility() {
     typedef Cartesian <NT> Kernel;
@@ -240,6 +291,10 @@ TEST_CASE("test_vaidya_center") {
     call_test_vaidya_center<double>();
 }
 
+TEST_CASE("test_max_ball_warm_start") {
+    call_test_max_ball_warm_start<double>();
+}
+
 TEST_CASE("test_max_ball_sparse") {
     call_test_max_ball_sparse<double>();
 }
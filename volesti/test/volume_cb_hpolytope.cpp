@@ -263,6 +263,27 @@ void call_test_skinny_cube() {
 }
 
 
+template <typename NT>
+void call_test_recycle_samples() {
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    typedef HPolytope<Point> Hpolytope;
+    Hpolytope P;
+    NT volume;
+
+    std::cout << "--- Testing volume of H-cube10 with recycled samples" << std::endl;
+    P = generate_cube<Hpolytope>(10, false);
+    RNGType rng(P.dimension());
+    volume = volume_cooling_balls<CDHRWalk>(P, rng, 0.1, 11, 300, true).second;
+    test_values(volume, NT(1024), NT(1024));
+
+    std::cout << "--- Testing volume of H-cross10 with recycled samples" << std::endl;
+    P = generate_cross<Hpolytope>(10, false);
+    volume = volume_cooling_balls<RDHRWalk>(P, rng, 0.1, 11, 300, true).second;
+    test_values(volume, NT(0.0002821869), NT(0.0002821869));
+}
+
 TEST_CASE("cube") {
     call_test_cube<double>();
     call_test_cube_float<float>();
@@ -288,3 +309,6 @@ TEST_CASE("skinny_cube") {
     call_test_skinny_cube<double>();
 }
 
+TEST_CASE("recycle_samples") {
+    call_test_recycle_samples<double>();
+}
@@ -152,8 +152,84 @@ void call_test_uniform_generator(){
 }
 
 
+void call_test_revolving_door(){
+    for (int n = 1; n <= 9; ++n) {
+        for (int t = 1; t <= n; ++t) {
+            std::uint64_t num_subsets = binomial_coefficient(n, t);
+            std::vector<bool> visited(1 << n, false);
+            revolving_door_combinations subset(n, t);
+            std::uint64_t rank = 0;
+            int out, in;
+            do {
+                unsigned int mask = 0;
+                for (int j = 0; j < t; ++j) mask |= 1u << subset[j];
+                CHECK(!visited[mask]);
+                visited[mask] = true;
+
+                // starting from the rank gives the same subset
+                revolving_door_combinations unranked(n, t, rank);
+                for (int j = 0; j < t; ++j) CHECK(unranked[j] == subset[j]);
+                rank++;
+
+                if (!subset.next(out, in)) break;
+                CHECK((mask & (1u << out)) != 0);
+                CHECK((mask & (1u << in)) == 0);
+            } while (true);
+            CHECK(rank == num_subsets);
+        }
+    }
+}
+
+template <typename NT>
+void call_test_exact_volume(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef boost::mt19937            RNGType;
+    typedef Zonotope<Point> zonotope;
+    typedef typename zonotope::MT MT;
+    typedef typename zonotope::VT VT;
+
+    // sum of |det| over all the subsets of [G, -G], the definition of the volume
+    auto brute_force_volume = [](zonotope const& Z) {
+        int n = Z.dimension(), k = Z.num_of_generators();
+        MT G = Z.get_mat().transpose(), V(n, 2 * k), SubV(n, n);
+        V << G, -G;
+        NT vol = 0;
+        for (auto const& c : comb(2 * k, n)) {
+            for (int j = 0; j < n; ++j) SubV.col(j) = V.col(c[j]);
+            vol += std::abs(SubV.determinant());
+        }
+        return vol;
+    };
+
+    zonotope P = gen_zonotope_uniform<zonotope, RNGType>(4, 11, 127);
+    NT exact_vol = exact_zonotope_vol<NT>(P);
+    NT brute_vol = brute_force_volume(P);
+    std::cout << "Exact volume " << exact_vol << " brute force " << brute_vol << std::endl;
+    CHECK(std::abs(exact_vol - brute_vol) < 1e-10 * brute_vol);
+
+    // integer generators with repetitions, many of the submatrices are singular
+    int n = 3, k = 40;
+    MT G(k, n);
+    for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < n; ++j) G(i, j) = NT((3 * i + 7 * j * (i % 4)) % 5) - NT(2);
+    }
+    P = zonotope(n, G, VT::Ones(2 * k));
+    exact_vol = exact_zonotope_vol<NT>(P);
+    brute_vol = brute_force_volume(P);
+    std::cout << "Exact volume " << exact_vol << " brute force " << brute_vol << std::endl;
+    CHECK(std::abs(exact_vol - brute_vol) < 1e-10 * brute_vol);
+}
+
 TEST_CASE("uniform_zonotopes") {
     call_test_uniform_generator<double>();
     //call_test_cube_float<float>();
 }
 
+TEST_CASE("revolving_door") {
+    call_test_revolving_door();
+}
+
+TEST_CASE("exact_volume") {
+    call_test_exact_volume<double>();
+}
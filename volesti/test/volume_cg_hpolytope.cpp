@@ -8,12 +8,17 @@
 #include "doctest.h"
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include <boost/random.hpp>
 #include <boost/random/uniform_int.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "misc/misc.h"
 
 #include "random_walks/random_walks.hpp"
@@ -278,6 +283,66 @@ void call_test_sparse_simplex() {
 
 
 
+template <typename NT>
+void call_test_multichain(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    Hpolytope P;
+    NT volume;
+
+    std::cout << "--- Testing multi-chain volume of H-cube10" << std::endl;
+    P = generate_cube<Hpolytope>(10, false);
+    volume = volume_cooling_gaussians<GaussianCDHRWalk, RNGType>(P, 0.1, 11, 4);
+    test_values(volume, NT(1024), NT(1024));
+
+    std::cout << "--- Testing multi-chain volume of H-cross10" << std::endl;
+    P = generate_cross<Hpolytope>(10, false);
+    volume = volume_cooling_gaussians<GaussianRDHRWalk, RNGType>(P, 0.1, 11, 8);
+    test_values(volume, NT(0.0002821869), NT(0.0002821869));
+
+#ifdef _OPENMP
+    // the chains pool their samples in chain order, so the estimate only
+    // depends on the seeds and not on the number of threads
+    std::cout << "--- Testing multi-chain volume of H-cube10 with 1, 2 and 4 threads" << std::endl;
+    P = generate_cube<Hpolytope>(10, false);
+    int max_threads = omp_get_max_threads();
+    std::vector<NT> volumes;
+    for (int num_threads : {1, 2, 4})
+    {
+        omp_set_num_threads(num_threads);
+        RNGType rng(P.dimension());
+        rng.set_seed(5);
+        volumes.push_back(volume_cooling_gaussians<GaussianCDHRWalk>(P, rng, 0.1, 11, 4));
+    }
+    omp_set_num_threads(max_threads);
+    test_values(volumes[0], NT(1024), NT(1024));
+    CHECK(volumes[1] == volumes[0]);
+    CHECK(volumes[2] == volumes[0]);
+#endif
+}
+
+template <typename NT>
+void call_test_pipelined(){
+    typedef Cartesian<NT>    Kernel;
+    typedef typename Kernel::Point    Point;
+    typedef HPolytope<Point> Hpolytope;
+    typedef BoostRandomNumberGenerator<boost::mt19937, NT, 3> RNGType;
+    Hpolytope P;
+    NT volume;
+
+    std::cout << "--- Testing pipelined volume of H-cube10" << std::endl;
+    P = generate_cube<Hpolytope>(10, false);
+    volume = volume_cooling_gaussians<GaussianCDHRWalk, RNGType>(P, 0.1, 11, 1, true);
+    test_values(volume, NT(1024), NT(1024));
+
+    std::cout << "--- Testing pipelined multi-chain volume of H-cross10" << std::endl;
+    P = generate_cross<Hpolytope>(10, false);
+    volume = volume_cooling_gaussians<GaussianRDHRWalk, RNGType>(P, 0.1, 11, 4, true);
+    test_values(volume, NT(0.0002821869), NT(0.0002821869));
+}
+
 TEST_CASE("cube") {
     call_test_cube<double>();
     call_test_cube_float<float>();
@@ -306,3 +371,11 @@ TEST_CASE("skinny_cube") {
 TEST_CASE("sparse_simplex") {
     call_test_sparse_simplex<double>();
 }
+
+TEST_CASE("multichain") {
+    call_test_multichain<double>();
+}
+
+TEST_CASE("pipelined") {
+    call_test_pipelined<double>();
+}